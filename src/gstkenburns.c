@@ -45,6 +45,74 @@ in half to create an effective 2x zoom on the letterboxed input image.
  * 
  * The real power comes from setting up controllers on the various parameters
  * to create transitions and Ken Burns effects.
+ *
+ * <title>Example with a motion path</title>
+ * |[
+ * gst-launch filesrc location=test.jpg ! decodebin2 ! imagefreeze ! kenburns motion-path="0:0,0,1; 5:0.5,0.5,2" motion-easing=in-out ! video/x-raw-yuv,width=640,height=480 ! autovideosink
+ * ]|
+ * For the common case of moving from one pose to the next, the motion-path
+ * property can be used instead of controllers. Each keyframe is of the form
+ * "t:xpos,ypos,zpos,xrot,yrot,zrot,fov" where t is the timestamp in seconds
+ * and trailing or empty fields are carried over from the previous keyframe.
+ * The path is evaluated directly for each frame and overrides the pose
+ * properties while it is set.
+ *
+ * <title>Source region hints</title>
+ * Usually only part of the source image is visible, and often at a
+ * fraction of its resolution. Whenever that changes significantly,
+ * kenburns sends a custom upstream "kenburns-roi" event with the int
+ * fields x, y, width and height (the needed part of the full source image,
+ * in its pixels) and the double field scale (the factor by which its
+ * resolution can be reduced). The region covers the current frame and the
+ * frames to come, or all of the remaining motion path if one is set.
+ * Elements that can decode or produce less, for example by IDCT scaling
+ * or cropping, can act on it. They must then send a custom downstream
+ * "kenburns-region" event ahead of the cropped or reduced frames, with
+ * the int fields full-width and full-height (the size of the full image)
+ * and x, y, width and height (the part of the full image the frames
+ * cover, in full image pixels). The frames can be of any size, and the
+ * poses keep referring to the full image.
+ *
+ * <title>Example with a tiled image</title>
+ * |[
+ * gst-launch videotestsrc pattern=black ! video/x-raw-rgb,bpp=32,depth=24,endianness=4321,red_mask=-16777216,green_mask=16711680,blue_mask=65280,framerate=25/1 ! kenburns location=panorama.kbt motion-path="0:-0.9,0,0.3; 60:0.9,0,0.3" ! video/x-raw-rgb,width=1280,height=720 ! autovideosink
+ * ]|
+ * Images too large for a buffer can be rendered from a tiled image
+ * pyramid file set with the location property (see gstkenburnstiles.h for
+ * the format). The input frames then only pace the output and must be in
+ * the pixel format of the file. For each frame only the tiles of the
+ * pyramid level matching the zoom are read, so the work and memory per
+ * frame depend on the output size rather than the image size.
+ *
+ * <title>Example with a format conversion</title>
+ * |[
+ * gst-launch filesrc location=test.jpg ! jpegdec ! imagefreeze ! kenburns zpos=0.5 ! video/x-raw-rgb,bpp=32,depth=24,width=640,height=480 ! ximagesink
+ * ]|
+ * The output format can differ from the input format. The conversion is
+ * done on the rendered pixels, band by band as they are rendered, which
+ * saves the separate pass over the output of a colorspace converter.
+ *
+ * <title>Tracing</title>
+ * When the GST_KENBURNS_TRACE environment variable is set to a file name,
+ * the time spent on each frame's setup, tile window, render bands and tile
+ * cache lookups is written to that file as a Chrome trace, which can be
+ * opened in chrome://tracing or Perfetto. Each event carries the thread it
+ * ran on and the timestamp of its frame in its frame argument.
+ *
+ * <title>Draft rendering</title>
+ * For interactive previews, for example while the pose is dragged around
+ * or the stream is scrubbed, the draft property can be set to 2 or 4.
+ * Frames are then rendered at that fraction of the output resolution with
+ * the fastest kernel and enlarged to the negotiated size for as long as
+ * the application keeps changing things, and at full quality again once
+ * it left them alone for draft-idle-time. The changes that count are
+ * setting the pose properties, motion-path or motion-easing, and flushing
+ * seeks. Changes made by controllers and the motion path itself are always
+ * rendered at full quality. The caps are not renegotiated either way.
+ * The return to full quality happens with the next frame, so in PAUSED the
+ * last draft stays on screen until a buffer arrives; an application that
+ * wants to see the full quality frame then can set draft to 1 and do a
+ * flushing seek to the current position.
  * </refsect2>
  * 
  */
@@ -55,6 +123,8 @@ in half to create an effective 2x zoom on the letterboxed input image.
 #endif
 
 #include "gstkenburns.h"
+#include "gstkenburnsxfade.h"
+#include "gstkenburnstrace.h"
 
 #include <string.h>
 #include <gst/gst.h>
@@ -72,13 +142,20 @@ in half to create an effective 2x zoom on the letterboxed input image.
 #define DEFAULT_BORDER   0
 #define DEFAULT_FOV 60
 #define DEFAULT_BGCOLOR 0x00000000
-
-enum {
-  BG_ALPHA,
-  BG_RED,
-  BG_GREEN,
-  BG_BLUE,
-};
+#define DEFAULT_MOTION_PATH NULL
+#define DEFAULT_MOTION_EASING GST_KENBURNS_EASING_LINEAR
+#define DEFAULT_MOTION_BLUR_SAMPLES 1
+#define MAX_MOTION_BLUR_SAMPLES 64
+/* poses sampled along the rest of the motion path for the source region */
+#define ROI_PATH_SAMPLES 32
+#define DEFAULT_LOCATION NULL
+#define DEFAULT_TILE_CACHE_SIZE 64
+/* the part of a tiled image read per frame is kept below this many times
+ * the output size */
+#define MAX_WINDOW_FACTOR 16
+#define DEFAULT_DRAFT 1
+#define MAX_DRAFT 8
+#define DEFAULT_DRAFT_IDLE_TIME (250 * GST_MSECOND)
 
 /* GstKenburns properties */
 
@@ -95,28 +172,17 @@ enum
   PROP_BORDER,
   PROP_FOV,
   PROP_BGCOLOR,
+  PROP_MOTION_PATH,
+  PROP_MOTION_EASING,
+  PROP_MOTION_BLUR_SAMPLES,
+  PROP_LOCATION,
+  PROP_TILE_CACHE_SIZE,
+  PROP_DRAFT,
+  PROP_DRAFT_IDLE_TIME,
   /* FILL ME */
 };
 
 
-#define COMP_Y(ret, r, g, b) \
-{ \
-   ret = (int) (((19595 * r) >> 16) + ((38470 * g) >> 16) + ((7471 * b) >> 16)); \
-   ret = CLAMP (ret, 0, 255); \
-}
-
-#define COMP_U(ret, r, g, b) \
-{ \
-   ret = (int) (-((11059 * r) >> 16) - ((21709 * g) >> 16) + ((32768 * b) >> 16) + 128); \
-   ret = CLAMP (ret, 0, 255); \
-}
-
-#define COMP_V(ret, r, g, b) \
-{ \
-   ret = (int) (((32768 * r) >> 16) - ((27439 * g) >> 16) - ((5329 * b) >> 16) + 128); \
-   ret = CLAMP (ret, 0, 255); \
-}
-
 GST_DEBUG_CATEGORY_STATIC (gst_kenburns_debug);
 #define GST_CAT_DEFAULT gst_kenburns_debug
 
@@ -129,6 +195,7 @@ static GstStaticPadTemplate gst_kenburns_src_template =
 		     GST_VIDEO_CAPS_ARGB ";" 
 		     GST_VIDEO_CAPS_RGBA ";" 
 		     GST_VIDEO_CAPS_ABGR ";"
+		     GST_VIDEO_CAPS_RGB  ";"
 		     GST_VIDEO_CAPS_BGR  ";" 
 		     GST_VIDEO_CAPS_xRGB ";" 
 		     GST_VIDEO_CAPS_xBGR ";"
@@ -145,6 +212,7 @@ static GstStaticPadTemplate gst_kenburns_sink_template =
 		     GST_VIDEO_CAPS_ARGB ";" 
 		     GST_VIDEO_CAPS_RGBA ";" 
 		     GST_VIDEO_CAPS_ABGR ";"
+		     GST_VIDEO_CAPS_RGB  ";"
 		     GST_VIDEO_CAPS_BGR  ";" 
 		     GST_VIDEO_CAPS_xRGB ";" 
 		     GST_VIDEO_CAPS_xBGR ";"
@@ -155,41 +223,190 @@ static GstStaticPadTemplate gst_kenburns_sink_template =
 GST_BOILERPLATE (GstKenburns, gst_kenburns, GstVideoFilter,
     GST_TYPE_VIDEO_FILTER);
 
-#define GST_TYPE_KENBURNS_INTERP_METHOD (gst_kenburns_interp_method_get_type())
+#define GST_TYPE_KENBURNS_EASING (gst_kenburns_easing_get_type())
 static GType
-gst_kenburns_interp_method_get_type (void)
+gst_kenburns_easing_get_type (void)
 {
-  static GType kenburns_interp_method_type = 0;
-  static const GEnumValue kenburns_interp_method[] = {
-    {GST_KENBURNS_INTERP_METHOD_NEAREST, "nearest", "nearest"},
+  static GType kenburns_easing_type = 0;
+  static const GEnumValue kenburns_easing[] = {
+    {GST_KENBURNS_EASING_LINEAR, "linear", "linear"},
+    {GST_KENBURNS_EASING_IN,     "ease in", "in"},
+    {GST_KENBURNS_EASING_OUT,    "ease out", "out"},
+    {GST_KENBURNS_EASING_IN_OUT, "ease in and out", "in-out"},
+    {GST_KENBURNS_EASING_SPLINE, "Catmull-Rom spline", "spline"},
     {0, NULL, NULL},
   };
 
-  if (!kenburns_interp_method_type) {
-    kenburns_interp_method_type =
-        g_enum_register_static ("GstKenburnsInterpType", kenburns_interp_method);
+  if (!kenburns_easing_type) {
+    kenburns_easing_type =
+        g_enum_register_static ("GstKenburnsEasing", kenburns_easing);
   }
-  return kenburns_interp_method_type;
+  return kenburns_easing_type;
+}
+
+/* With a tiled image the poses are worked out on its full resolution
+ * level before the part of it needed is known. */
+static void
+gst_kenburns_use_full_image (GstKenburns * kb)
+{
+  kb->renderer.src_width  = kb->tiles.width;
+  kb->renderer.src_height = kb->tiles.height;
+  kb->renderer.region_width = kb->renderer.region_height = 0;
 }
 
 static gboolean gst_kenburns_set_caps (GstBaseTransform *trans, GstCaps *incaps, GstCaps *outcaps) {
   GstKenburns *kb = GST_KENBURNS (trans);
   gboolean ret;
-  ret = gst_video_format_parse_caps (incaps, &kb->src_fmt, &kb->src_width, &kb->src_height);
+  ret = gst_video_format_parse_caps (incaps, &kb->renderer.src_fmt,
+      &kb->renderer.src_width, &kb->renderer.src_height);
   if (!ret) {
     GST_ERROR_OBJECT (trans, "Invalid caps: %" GST_PTR_FORMAT, incaps);
     return FALSE;
   }
 
-  ret = gst_video_format_parse_caps (outcaps, &kb->dst_fmt, &kb->dst_width, &kb->dst_height);
+  ret = gst_video_format_parse_caps (outcaps, &kb->renderer.dst_fmt,
+      &kb->renderer.dst_width, &kb->renderer.dst_height);
   if (!ret) {
     GST_ERROR_OBJECT (trans, "Invalid caps: %" GST_PTR_FORMAT, outcaps);
     return FALSE;
   }
 
+  if (!gst_video_parse_caps_framerate (incaps, &kb->fps_n, &kb->fps_d)) {
+    kb->fps_n = 0;
+    kb->fps_d = 1;
+  }
+
+  if (kb->have_tiles) {
+    if (kb->renderer.src_fmt != kb->tiles.format) {
+      GST_ERROR_OBJECT (trans, "Input format does not match the tiled image");
+      return FALSE;
+    }
+    gst_kenburns_use_full_image (kb);
+  }
+
+  GST_OBJECT_LOCK (kb);
+  gst_kenburns_renderer_configure (&kb->renderer);
+  GST_OBJECT_UNLOCK (kb);
+
+  return TRUE;
+}
+
+static gboolean
+gst_kenburns_start (GstBaseTransform * trans)
+{
+  GstKenburns *kb = GST_KENBURNS (trans);
+  GError *err = NULL;
+  gchar *location;
+  guint cache_size;
+
+  kb->have_prev_pose = FALSE;
+  kb->last_change = GST_CLOCK_TIME_NONE;
+  kb->have_roi = FALSE;
+  kb->have_window = FALSE;
+  kb->renderer.region_width = kb->renderer.region_height = 0;
+
+  GST_OBJECT_LOCK (kb);
+  location = g_strdup (kb->location);
+  cache_size = kb->tile_cache_size;
+  GST_OBJECT_UNLOCK (kb);
+
+  if (location != NULL) {
+    if (!gst_kenburns_tiles_open (&kb->tiles, location, cache_size, &err)) {
+      GST_ELEMENT_ERROR (kb, RESOURCE, OPEN_READ, (NULL), ("%s", err->message));
+      g_error_free (err);
+      g_free (location);
+      return FALSE;
+    }
+    kb->have_tiles = TRUE;
+    g_free (location);
+  }
+  return TRUE;
+}
+
+static gboolean
+gst_kenburns_stop (GstBaseTransform * trans)
+{
+  GstKenburns *kb = GST_KENBURNS (trans);
+
+  if (kb->have_tiles)
+    gst_kenburns_tiles_close (&kb->tiles);
+  kb->have_tiles = FALSE;
+  g_free (kb->window);
+  kb->window = NULL;
+  kb->window_size = 0;
+  kb->have_window = FALSE;
   return TRUE;
 }
 
+/* Picks up the part of the full source image the following frames cover
+ * from the serialized "kenburns-region" event of a cooperating element
+ * upstream. */
+static gboolean
+gst_kenburns_event (GstBaseTransform * trans, GstEvent * event)
+{
+  GstKenburns *kb = GST_KENBURNS (trans);
+  const GstStructure *s;
+  gint full_width, full_height, x, y, width, height;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CUSTOM_DOWNSTREAM:
+      s = gst_event_get_structure (event);
+      if (s == NULL || !gst_structure_has_name (s, "kenburns-region"))
+        break;
+      if (gst_structure_get_int (s, "full-width", &full_width) &&
+          gst_structure_get_int (s, "full-height", &full_height) &&
+          gst_structure_get_int (s, "x", &x) &&
+          gst_structure_get_int (s, "y", &y) &&
+          gst_structure_get_int (s, "width", &width) &&
+          gst_structure_get_int (s, "height", &height) &&
+          x >= 0 && y >= 0 && width > 0 && height > 0 &&
+          x + width <= full_width && y + height <= full_height) {
+        GST_OBJECT_LOCK (kb);
+        kb->renderer.full_width    = full_width;
+        kb->renderer.full_height   = full_height;
+        kb->renderer.region_x      = x;
+        kb->renderer.region_y      = y;
+        kb->renderer.region_width  = width;
+        kb->renderer.region_height = height;
+        GST_OBJECT_UNLOCK (kb);
+      } else {
+        GST_WARNING_OBJECT (kb, "Invalid region %" GST_PTR_FORMAT, s);
+      }
+      /* nobody downstream cares */
+      return FALSE;
+    case GST_EVENT_FLUSH_STOP:
+      GST_OBJECT_LOCK (kb);
+      kb->have_roi = FALSE;
+      /* a flushing seek is the application scrubbing, a change for the
+       * drafts like setting the pose */
+      kb->last_change = gst_util_get_timestamp ();
+      GST_OBJECT_UNLOCK (kb);
+      break;
+    default:
+      break;
+  }
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->event (trans, event);
+}
+
+static gboolean
+gst_kenburns_src_event (GstBaseTransform * trans, GstEvent * event)
+{
+  const GstStructure *s;
+
+  /* a region requested by another kenburns further downstream is in the
+   * coordinates of our output, we send our own */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CUSTOM_UPSTREAM) {
+    s = gst_event_get_structure (event);
+    if (s != NULL && gst_structure_has_name (s, "kenburns-roi")) {
+      gst_event_unref (event);
+      return TRUE;
+    }
+  }
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->src_event (trans, event);
+}
+
 static GstCaps *
 gst_kenburns_transform_caps (GstBaseTransform * trans,
     GstPadDirection direction, GstCaps * from)
@@ -209,6 +426,16 @@ gst_kenburns_transform_caps (GstBaseTransform * trans,
   gst_structure_remove_field (structure, "width");
   gst_structure_remove_field (structure, "height");
 
+  /* the format can change too, the conversion is done while rendering.
+   * Keeping it is preferred. */
+  structure = gst_structure_copy (structure);
+  gst_structure_remove_fields (structure, "format", "bpp", "depth",
+      "endianness", "red_mask", "green_mask", "blue_mask", "alpha_mask", NULL);
+  gst_structure_set_name (structure, "video/x-raw-yuv");
+  gst_caps_append_structure (to, gst_structure_copy (structure));
+  gst_structure_set_name (structure, "video/x-raw-rgb");
+  gst_caps_append_structure (to, structure);
+
   // everything else has to stay identical
 
   /* filter against set allowed caps on the pad */
@@ -224,269 +451,327 @@ gst_kenburns_transform_caps (GstBaseTransform * trans,
   return ret;
 }
 
-#if 0
-#define FRAC gint64
-#define FRAC_WIDTH 12
-#define INT2FRAC(x)    (x << FRAC_WIDTH)
-#define DBL2FRAC(x)    ((int) (x*(1<< FRAC_WIDTH)))
-#define FRAC_MULT(x,y) ((x*y) >> FRAC_WIDTH)
-#define FRAC_DIV(x,y)  ((x<<FRAC_WIDTH)/y)
-#define FLOOR_FRAC(x)  (x >> FRAC_WIDTH)
-#define INC_FROM_ZERO  1
-#else
-#define FRAC double
-#define INT2FRAC(x)    ((double) x)
-#define DBL2FRAC(x)    (x)
-#define FRAC_MULT(x,y) (x*y)
-#define FRAC_DIV(x,y)  (x/y)
-#define FLOOR_FRAC(x)  ((int) floor(x))
-#define INC_FROM_ZERO  1e-9
-#endif
-
-#define TRANSFORM_SETUP(kb) \
-  double src_aspect_ratio, dst_aspect_ratio; \
-  FRAC cos_thetax, sin_thetax, tan_thetax; \
-  FRAC cos_thetay, sin_thetay, tan_thetay; \
-  FRAC cos_thetaz, sin_thetaz, tan_thetax_on_cos_thetay;		\
-  FRAC wsrc, hsrc, wlb, hlb, zoomx, zoomy, yd0, xd0, xs3, ys3, z1, zpos; \
-  \
-  src_aspect_ratio  = kb->src_width / (double) kb->src_height; \
-  dst_aspect_ratio  = kb->dst_width / (double) kb->dst_height; \
-  /* calculate letterbox width and height based on output aspect ratio */\
-  if(src_aspect_ratio > dst_aspect_ratio) {				\
-    wlb  = INT2FRAC(kb->src_width);  /* letterbox width */		\
-    wsrc = wlb;                          /* actual width is the same */ \
-    hlb  = wlb * kb->dst_height / kb->dst_width; /* letterbox height */ \
-    hsrc = INT2FRAC(kb->src_height);  /* actual height */	\
-  } else { \
-    hlb  = INT2FRAC(kb->src_height);	         \
-    hsrc = hlb;                                  \
-    wlb  = hlb * kb->dst_width / kb->dst_height; \
-    wsrc = INT2FRAC(kb->src_width);	         \
-  } \
-  zoomx = wlb / kb->dst_width;  \
-  zoomy = hlb / kb->dst_height; \
-  \
-  cos_thetax = DBL2FRAC(cos(kb->xrot*M_PI/180)); \
-  sin_thetax = DBL2FRAC(sin(kb->xrot*M_PI/180)); \
-  tan_thetax = DBL2FRAC(tan(kb->xrot*M_PI/180)); \
-  cos_thetay = DBL2FRAC(cos(kb->yrot*M_PI/180)); \
-  sin_thetay = DBL2FRAC(sin(kb->yrot*M_PI/180)); \
-  tan_thetay = DBL2FRAC(tan(kb->yrot*M_PI/180)); \
-  cos_thetaz = DBL2FRAC(cos(kb->zrot*M_PI/180)); \
-  sin_thetaz = DBL2FRAC(sin(kb->zrot*M_PI/180)); \
-  if(cos_thetay == 0) { cos_thetay= INC_FROM_ZERO; } \
-  tan_thetax_on_cos_thetay = FRAC_DIV(tan_thetax,cos_thetay); \
-  \
-  xd0 = DBL2FRAC(0.5 + kb->dst_width  * (kb->xpos/2/kb->zpos - 0.5)); \
-  yd0 = DBL2FRAC(0.5 + kb->dst_height * (kb->ypos/2/kb->zpos - 0.5)); \
-  xs3 = ((FRAC) (wsrc / kb->zpos)) / 2;		\
-  ys3 = ((FRAC) (hsrc / kb->zpos)) / 2;		\
-  zpos = DBL2FRAC(kb->zpos); \
-  \
-  /* z1 is the distance is pixels required for the requested fov to see get \
-     the letterbox image perfectly framed.*/ \
-  z1 = (FRAC) (((wlb > hlb) ? wlb : hlb) / 2 / tan(kb->fov / 2 / 180 * M_PI));
-
-// This is when no rotation is used, it avoids a lot of calculations and
-// is therefore faster.
-#define TRANSLATE(xsrc, ysrc, xdst, ydst) \
-  {   \
-      FRAC x0, y0;	\
-      \
-      /* translate dest image coordinates to input image coordinates	\
-         (0,0) at the center of the input image */			\
-      x0 = FRAC_MULT ((INT2FRAC (xdst) + xd0 ), zoomx);			\
-      y0 = FRAC_MULT ((INT2FRAC (ydst) + yd0 ), zoomy);			\
-      \
-      /* perform zoom and translation and then translate back to (0,0) in
-         the upper left corner */    \
-      xsrc = FRAC_MULT ((x0 + xs3), zpos);	   \
-      ysrc = FRAC_MULT ((y0 + ys3), zpos);	   \
-  }
-
-// This is what we use when a rotation is requested.
-#define TRANSFORM(xsrc, ysrc, xdst, ydst) \
-  {   \
-      FRAC x0, y0, x1, y1, x2, y2, z2, x3, y3, det;	\
-      \
-      /* translate dest image coordinates to input image coordinates	\
-         (0,0) at the center of the input image */			\
-      x0 = FRAC_MULT ((INT2FRAC (xdst) + xd0 ), zoomx);			\
-      y0 = FRAC_MULT ((INT2FRAC (ydst) + yd0 ), zoomy);			\
-      \
-      /* do the z-axis rotation first because it is easiest */	\
-      x1 =  FRAC_MULT(x0, cos_thetaz) - FRAC_MULT(y0, sin_thetaz);	\
-      y1 =  FRAC_MULT(x0, sin_thetaz) + FRAC_MULT(y0, cos_thetaz);	\
-      \
-      /* now find where the x/y axis rotations intersect the current ray \
-	 of vision. */ \
-      det = FRAC_MULT(-x1, tan_thetax_on_cos_thetay) + FRAC_MULT(y1, tan_thetay) + z1; \
-      if( det == 0) { det = INC_FROM_ZERO; } \
-      x2 = FRAC_DIV(FRAC_MULT(x1, z1), det); \
-      y2 = FRAC_DIV(FRAC_MULT(y1, z1), det); \
-      z2 = FRAC_DIV(FRAC_MULT(z1, z1), det) - z1; \
-      \
-      /* rotate back to source image plane */		\
-      x3 =  FRAC_MULT(x2, cos_thetax) + FRAC_MULT(FRAC_MULT(y2, sin_thetay), sin_thetax) + FRAC_MULT(FRAC_MULT(z2, cos_thetay), sin_thetax); \
-      y3 =  FRAC_MULT(y2, cos_thetay) - FRAC_MULT(z2, sin_thetay);	\
-      \
-      /* perform zoom and translation and then translate back to (0,0) in
-         the upper left corner */    \
-      xsrc = FRAC_MULT ((x3 + xs3), zpos);	   \
-      ysrc = FRAC_MULT ((y3 + ys3), zpos);	   \
+/* Sets kb->render_pose, the pose the buffer about to be rendered is shown
+ * in, and computes kb->pose_delta, the change of the pose over one frame
+ * period. The render pose is evaluated from the motion path when one is
+ * active and is the pose properties otherwise, which are left as the
+ * application set them either way. Must be called with the object lock
+ * held. */
+static void
+gst_kenburns_update_pose (GstKenburns * kb, GstBuffer * in)
+{
+  GstClockTime ts = GST_BUFFER_TIMESTAMP (in);
+  GstKenburnsPose velocity;
+  gdouble period = 0;
+  guint i;
+
+  if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_DURATION (in)))
+    period = (gdouble) GST_BUFFER_DURATION (in) / GST_SECOND;
+  else if (kb->fps_n > 0)
+    period = (gdouble) kb->fps_d / kb->fps_n;
+  kb->frame_period = period;
+
+  if (gst_kenburns_motion_active (&kb->motion) && GST_CLOCK_TIME_IS_VALID (ts)) {
+    gst_kenburns_motion_eval (&kb->motion, ts, &kb->render_pose, &velocity);
+    /* splines can overshoot the keyframes */
+    kb->render_pose.zpos = MAX (kb->render_pose.zpos, 0.001);
+    kb->render_pose.fov  = CLAMP (kb->render_pose.fov, 0.001, 180);
+    for (i = 0; i < GST_KENBURNS_POSE_N_FIELDS; i++)
+      GST_KENBURNS_POSE_FIELD (&kb->pose_delta, i) =
+          GST_KENBURNS_POSE_FIELD (&velocity, i) * period;
+  } else {
+    kb->render_pose = kb->pose;
+    if (kb->have_prev_pose && !GST_BUFFER_IS_DISCONT (in)) {
+      for (i = 0; i < GST_KENBURNS_POSE_N_FIELDS; i++)
+        GST_KENBURNS_POSE_FIELD (&kb->pose_delta, i) =
+            GST_KENBURNS_POSE_FIELD (&kb->render_pose, i) -
+            GST_KENBURNS_POSE_FIELD (&kb->prev_pose, i);
+    } else {
+      memset (&kb->pose_delta, 0, sizeof (kb->pose_delta));
+    }
   }
 
-#define OUT_OF_BOUNDS(kb, xsrc, ysrc, xdst, ydst)	\
-  (xsrc < 0 || xsrc >= kb->src_width  || \
-   ysrc < 0 || ysrc >= kb->src_height || \
-   xdst < kb->border || xdst >= kb->dst_width  - kb->border || \
-   ydst < kb->border || ydst >= kb->dst_height - kb->border)
-
-#define NEAREST_NEIGHBOR_I420(kb, src, dst) \
-     /* We have the position of source image as a float, so convert it \
-        to the nearest neighbor. */				    \
-      xsrc = FLOOR_FRAC(xsrc0); \
-      ysrc = FLOOR_FRAC(ysrc0); \
-      \
-      /* check if this pixel is in bounds and if not, then pass the specified\
-      // background color. */ \
-      if( OUT_OF_BOUNDS (kb, xsrc, ysrc, xdst, ydst) ) {\
-        /* use provided background color pixel is out of bounds */	\
-	Y = bgcolor[0];\
-	U = bgcolor[1];\
-	V = bgcolor[2];\
-      } else {\
-        /* otherwise copy the nearest neighbor pixel */ \
-	posYsrc = xsrc   + ysrc   * src_strideY;\
-	posUsrc = xsrc/2 + ysrc/2 * src_strideUV + src_offsetU;\
-	posVsrc = xsrc/2 + ysrc/2 * src_strideUV + src_offsetV;\
-	Y = src[posYsrc];\
-	U = src[posUsrc];\
-	V = src[posVsrc];\
-      }\
-      posYdst = xdst   + ydst   * dst_strideY;\
-      posUdst = xdst/2 + ydst/2 * dst_strideUV + dst_offsetU;\
-      posVdst = xdst/2 + ydst/2 * dst_strideUV + dst_offsetV;\
-      dst[posYdst] = Y;\
-      dst[posUdst] = U;\
-      dst[posVdst] = V;
-
-#define NEAREST_NEIGHBOR(kb, src, dst, num_bytes)					\
-      /* We have the position of source image as a float, so convert it \
-         to the nearest neighbor. */ \
-      xsrc = FLOOR_FRAC(xsrc0);\
-      ysrc = FLOOR_FRAC(ysrc0);\
-      \
-      pos_dst = xdst*num_bytes + ydst * dst_stride;\
-      pos_src = xsrc*num_bytes + ysrc * src_stride;\
-      \
-      /* check if this pixel is in bounds and if not, then pass the specified \
-      background color.*/ \
-      if( OUT_OF_BOUNDS (kb, xsrc, ysrc, xdst, ydst) ) { \
-	/* use transparent black if requesting a pixel that is out of bounds*/ \
-	memcpy(dst + pos_dst, bgcolor, num_bytes); \
-      } else { \
-	/* otherwise copy the nearest neighbor pixel */ \
-	memcpy(dst + pos_dst, src + pos_src, num_bytes);\
-      }
-
-
-static void transform_XXXX(GstKenburns *kb, const guint8 *src, guint8 *dst, 
-			   guint8 *bgcolor) {
-  FRAC xsrc0, ysrc0;
-  int xdst, ydst, xsrc, ysrc;
-  int pos_dst, pos_src;
-  int dst_stride, src_stride; 
+  kb->prev_pose = kb->render_pose;
+  kb->have_prev_pose = TRUE;
+}
 
-  dst_stride = gst_video_format_get_row_stride(kb->dst_fmt, 0, kb->dst_width);
-  src_stride = gst_video_format_get_row_stride(kb->src_fmt, 0, kb->src_width);
+/* Notes that the application changed the pose or the motion path, for the
+ * draft rendering. Changes made by the controllers while the properties
+ * are synced to a frame do not count: the animated pose is meant to be
+ * rendered at full quality. Must be called with the object lock held. */
+static void
+gst_kenburns_pose_changed (GstKenburns * kb)
+{
+  if (!kb->syncing)
+    kb->last_change = gst_util_get_timestamp ();
+}
 
-  TRANSFORM_SETUP(kb);
+/* Returns whether the current frame is to be rendered as a draft, that is
+ * draft rendering is enabled and the application changed the pose, the
+ * motion path or the position less than the idle time ago. The idle time is measured on the system clock
+ * rather than in stream time, since it is about how long someone adjusting
+ * the pose has left it alone. Must be called with the object lock held. */
+static gboolean
+gst_kenburns_use_draft (GstKenburns * kb)
+{
+  return kb->draft > 1 && GST_CLOCK_TIME_IS_VALID (kb->last_change) &&
+      gst_util_get_timestamp () - kb->last_change < kb->draft_idle_time;
+}
 
-  if (kb->xrot || kb->yrot || kb->zrot) {
-    for(ydst=0; ydst < kb->dst_height; ydst++) {
-      for(xdst=0; xdst < kb->dst_width; xdst++) {
-	TRANSFORM (xsrc0, ysrc0, xdst, ydst);
-	NEAREST_NEIGHBOR(kb, src, dst, 4);
-      }
-    }
+/* Returns the pose at fraction f (-0.5 to 0.5) of a frame period away
+ * from the timestamp ts of the current frame. */
+static void
+gst_kenburns_subframe_pose (GstKenburns * kb, GstClockTime ts, gdouble f,
+    GstKenburnsPose * pose)
+{
+  GstKenburnsPose velocity;
+  gint64 offset;
+  guint i;
+
+  if (gst_kenburns_motion_active (&kb->motion) && GST_CLOCK_TIME_IS_VALID (ts)) {
+    offset = (gint64) (f * kb->frame_period * GST_SECOND);
+    if (offset < 0 && (GstClockTime) -offset > ts)
+      offset = -(gint64) ts;
+    gst_kenburns_motion_eval (&kb->motion, ts + offset, pose, &velocity);
+    pose->zpos = MAX (pose->zpos, 0.001);
+    pose->fov  = CLAMP (pose->fov, 0.001, 180);
   } else {
-    for(ydst=0; ydst < kb->dst_height; ydst++) {
-      for(xdst=0; xdst < kb->dst_width; xdst++) {
-	TRANSLATE (xsrc0, ysrc0, xdst, ydst);
-	NEAREST_NEIGHBOR(kb, src, dst, 4);
-      }
-    }
+    /* assume constant velocity over the frame */
+    for (i = 0; i < GST_KENBURNS_POSE_N_FIELDS; i++)
+      GST_KENBURNS_POSE_FIELD (pose, i) =
+          GST_KENBURNS_POSE_FIELD (&kb->render_pose, i) +
+          GST_KENBURNS_POSE_FIELD (&kb->pose_delta, i) * f;
+    pose->zpos = MAX (pose->zpos, 0.001);
   }
 }
 
-static void transform_XXX(GstKenburns *kb, const guint8 *src, guint8 *dst, 
-			  guint8 *bgcolor) {
-  FRAC xsrc0, ysrc0;
-  int xdst, ydst, xsrc, ysrc;
-  int pos_dst, pos_src;
-  int dst_stride, src_stride; 
+/* Sets up the mappings of the sub-frame samples used to render the current
+ * frame and returns how many there are. More samples than the number of
+ * output pixels the image travels over during the frame do not improve the
+ * blur, so the motion-blur-samples property is only an upper bound. The
+ * travel is measured at the corners and center of the output between the
+ * first and last sub-frame pose. */
+static gint
+gst_kenburns_setup_mappings (GstKenburns * kb, GstClockTime ts,
+    GstKenburnsMapping * maps)
+{
+  static const gdouble fx[] = { 0, 1, 0, 1, 0.5 };
+  static const gdouble fy[] = { 0, 0, 1, 1, 0.5 };
+  GstKenburnsPose pose;
+  GstKenburnsMapping first, last;
+  gdouble xa, ya, xb, yb, xd, yd, travel = 0, scale;
+  gint i, n = kb->motion_blur_samples;
+
+  for (i = 0; i < GST_KENBURNS_POSE_N_FIELDS; i++)
+    if (GST_KENBURNS_POSE_FIELD (&kb->pose_delta, i) != 0)
+      break;
+  if (n <= 1 || i == GST_KENBURNS_POSE_N_FIELDS) {
+    gst_kenburns_mapping_setup (&kb->renderer, &kb->render_pose, &maps[0]);
+    return 1;
+  }
 
-  dst_stride = gst_video_format_get_row_stride(kb->dst_fmt, 0, kb->dst_width);
-  src_stride = gst_video_format_get_row_stride(kb->src_fmt, 0, kb->src_width);
+  gst_kenburns_subframe_pose (kb, ts, 0.5 / n - 0.5, &pose);
+  gst_kenburns_mapping_setup (&kb->renderer, &pose, &first);
+  gst_kenburns_subframe_pose (kb, ts, 0.5 - 0.5 / n, &pose);
+  gst_kenburns_mapping_setup (&kb->renderer, &pose, &last);
+
+  for (i = 0; i < G_N_ELEMENTS (fx); i++) {
+    xd = fx[i] * (kb->renderer.dst_width - 1);
+    yd = fy[i] * (kb->renderer.dst_height - 1);
+    gst_kenburns_mapping_apply (&first, xd, yd, &xa, &ya);
+    gst_kenburns_mapping_apply (&last,  xd, yd, &xb, &yb);
+    travel = MAX (travel, sqrt ((xb - xa) * (xb - xa) + (yb - ya) * (yb - ya)));
+  }
+  /* source pixels per output pixel */
+  scale = MAX (first.zoomx * first.zposx, 1e-9);
+  n = CLAMP ((gint) ceil (travel / scale), 1, n);
 
-  TRANSFORM_SETUP(kb);
+  if (n == 1) {
+    gst_kenburns_mapping_setup (&kb->renderer, &kb->render_pose, &maps[0]);
+    return 1;
+  }
+  for (i = 0; i < n; i++) {
+    gst_kenburns_subframe_pose (kb, ts, (i + 0.5) / n - 0.5, &pose);
+    gst_kenburns_mapping_setup (&kb->renderer, &pose, &maps[i]);
+  }
+  return n;
+}
 
-  if (kb->xrot || kb->yrot || kb->zrot) {
-    for(ydst=0; ydst < kb->dst_height; ydst++) {
-      for(xdst=0; xdst < kb->dst_width; xdst++) {
-	TRANSFORM (xsrc0, ysrc0, xdst, ydst);
-	NEAREST_NEIGHBOR(kb, src, dst, 3);
-      }
+/* Grows rect and reduces scale by what mapping m of renderer r needs of
+ * the source. */
+static void
+gst_kenburns_roi_add (const GstKenburnsRenderer * r,
+    const GstKenburnsMapping * m, gdouble rect[4], gdouble * scale)
+{
+  gdouble bounds[4], s;
+
+  gst_kenburns_mapping_bounds (r, m, bounds, &s);
+  rect[0] = MIN (rect[0], bounds[0]);
+  rect[1] = MIN (rect[1], bounds[1]);
+  rect[2] = MAX (rect[2], bounds[2]);
+  rect[3] = MAX (rect[3], bounds[3]);
+  *scale = MIN (*scale, s);
+}
+
+/* Works out the part of the full source image and the resolution needed
+ * for the current frame and the frames to come, and returns a
+ * "kenburns-roi" event to send upstream if that differs enough from what
+ * was requested last. With a motion path all of the rest of the path is
+ * covered, since upstream often decodes a still image only once. Without
+ * one, the next frame is extrapolated from the change of the pose over the
+ * current frame. Must be called with the object lock held. */
+static GstEvent *
+gst_kenburns_request_region (GstKenburns * kb, GstClockTime ts,
+    const GstKenburnsMapping * maps, gint n)
+{
+  GstKenburnsMotion *motion = &kb->motion;
+  GstKenburnsPose pose, velocity;
+  GstKenburnsMapping m;
+  GstClockTime end;
+  gdouble rect[4] = { G_MAXDOUBLE, G_MAXDOUBLE, -G_MAXDOUBLE, -G_MAXDOUBLE };
+  gdouble scale = G_MAXDOUBLE;
+  gint i, roi[4];
+
+  for (i = 0; i < n; i++)
+    gst_kenburns_roi_add (&kb->renderer, &maps[i], rect, &scale);
+
+  if (gst_kenburns_motion_active (motion) && GST_CLOCK_TIME_IS_VALID (ts)) {
+    end = g_array_index (motion->keyframes, GstKenburnsKeyframe,
+        motion->keyframes->len - 1).time;
+    for (i = 1; ts < end && i <= ROI_PATH_SAMPLES; i++) {
+      gst_kenburns_motion_eval (motion, ts + (end - ts) * i / ROI_PATH_SAMPLES,
+          &pose, &velocity);
+      pose.zpos = MAX (pose.zpos, 0.001);
+      pose.fov  = CLAMP (pose.fov, 0.001, 180);
+      gst_kenburns_mapping_setup (&kb->renderer, &pose, &m);
+      gst_kenburns_roi_add (&kb->renderer, &m, rect, &scale);
     }
   } else {
-    for(ydst=0; ydst < kb->dst_height; ydst++) {
-      for(xdst=0; xdst < kb->dst_width; xdst++) {
-	TRANSLATE (xsrc0, ysrc0, xdst, ydst);
-	NEAREST_NEIGHBOR(kb, src, dst, 3);
-      }
-    }
+    for (i = 0; i < GST_KENBURNS_POSE_N_FIELDS; i++)
+      GST_KENBURNS_POSE_FIELD (&pose, i) =
+          GST_KENBURNS_POSE_FIELD (&kb->render_pose, i) +
+          GST_KENBURNS_POSE_FIELD (&kb->pose_delta, i);
+    pose.zpos = MAX (pose.zpos, 0.001);
+    gst_kenburns_mapping_setup (&kb->renderer, &pose, &m);
+    gst_kenburns_roi_add (&kb->renderer, &m, rect, &scale);
   }
+
+  roi[0] = (gint) floor (rect[0]);
+  roi[1] = (gint) floor (rect[1]);
+  roi[2] = (gint) ceil (rect[2]);
+  roi[3] = (gint) ceil (rect[3]);
+  /* nothing of the source is visible, keep what was asked for */
+  if (roi[2] <= roi[0] || roi[3] <= roi[1])
+    return NULL;
+  scale = MAX (scale, 1.0);
+
+  /* only ask again when more is needed, or when at least half of the
+   * area or resolution could be saved */
+  if (kb->have_roi &&
+      roi[0] >= kb->roi[0] && roi[1] >= kb->roi[1] &&
+      roi[2] <= kb->roi[2] && roi[3] <= kb->roi[3] &&
+      scale >= kb->roi_scale && scale < 2 * kb->roi_scale &&
+      2.0 * (roi[2] - roi[0]) * (roi[3] - roi[1]) >=
+      (gdouble) (kb->roi[2] - kb->roi[0]) * (kb->roi[3] - kb->roi[1]))
+    return NULL;
+
+  kb->have_roi = TRUE;
+  memcpy (kb->roi, roi, sizeof (roi));
+  kb->roi_scale = scale;
+  GST_DEBUG_OBJECT (kb, "requesting %dx%d+%d+%d reduced %g times",
+      roi[2] - roi[0], roi[3] - roi[1], roi[0], roi[1], scale);
+
+  return gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+      gst_structure_new ("kenburns-roi",
+          "x", G_TYPE_INT, roi[0],
+          "y", G_TYPE_INT, roi[1],
+          "width", G_TYPE_INT, roi[2] - roi[0],
+          "height", G_TYPE_INT, roi[3] - roi[1],
+          "scale", G_TYPE_DOUBLE, scale, NULL));
 }
 
-static void transform_i420(GstKenburns *kb, const guint8 *src, guint8 *dst,
-			   guint8 *bgcolor) {
-  FRAC xsrc0, ysrc0;
-  int xdst, ydst, xsrc, ysrc;
-  int dst_strideY, dst_strideUV, src_strideY, src_strideUV;
-  int dst_offsetU, dst_offsetV,  src_offsetU, src_offsetV;
-  int posYdst, posUdst, posVdst;
-  int posYsrc, posUsrc, posVsrc;
-  int Y, U, V;
-
-  dst_strideY  = gst_video_format_get_row_stride(kb->dst_fmt, 0, kb->dst_width);
-  dst_strideUV = gst_video_format_get_row_stride(kb->dst_fmt, 1, kb->dst_width);
-  src_strideY  = gst_video_format_get_row_stride(kb->src_fmt, 0, kb->src_width);
-  src_strideUV = gst_video_format_get_row_stride(kb->src_fmt, 1, kb->src_width);
-
-  dst_offsetU = gst_video_format_get_component_offset(kb->dst_fmt, 1, kb->dst_width, kb->dst_height);
-  dst_offsetV = gst_video_format_get_component_offset(kb->dst_fmt, 2, kb->dst_width, kb->dst_height);
-  src_offsetU = gst_video_format_get_component_offset(kb->src_fmt, 1, kb->src_width, kb->src_height);
-  src_offsetV = gst_video_format_get_component_offset(kb->src_fmt, 2, kb->src_width, kb->src_height);
-
-  TRANSFORM_SETUP(kb);
-
-  if (kb->xrot || kb->yrot || kb->zrot) {
-    for(ydst=0; ydst < kb->dst_height; ydst++) {
-      for(xdst=0; xdst < kb->dst_width; xdst++) {
-	TRANSFORM (xsrc0, ysrc0, xdst, ydst);
-	NEAREST_NEIGHBOR_I420(kb, src, dst);
-      }
-    }
-  } else {
-    for(ydst=0; ydst < kb->dst_height; ydst++) {
-      for(xdst=0; xdst < kb->dst_width; xdst++) {
-	TRANSLATE (xsrc0, ysrc0, xdst, ydst);
-	NEAREST_NEIGHBOR_I420(kb, src, dst);
-      }
+/* Reads the part of the tiled image that the mappings of the current frame
+ * need into kb->window, from the coarsest pyramid level with at least one
+ * pixel per output pixel, and moves the mappings and r, the copy of the
+ * renderer used for the frame, over to it. If even the coarsest level
+ * needs too large a window, every step-th pixel of it is read. The window
+ * is only read again when that part, level or step changed since the
+ * previous frame. The tiles and the window are only used by the streaming
+ * thread, so this is called without the object lock. */
+static const guint8 *
+gst_kenburns_load_window (GstKenburns * kb, GstKenburnsRenderer * r,
+    GstKenburnsMapping * maps, gint n)
+{
+  GstKenburnsTiles *tiles = &kb->tiles;
+  gdouble rect[4] = { G_MAXDOUBLE, G_MAXDOUBLE, -G_MAXDOUBLE, -G_MAXDOUBLE };
+  gdouble scale = G_MAXDOUBLE;
+  gint i, level, f, width, height, x0, y0, x1, y1, w, h, step, stride;
+  gint64 max_area = (gint64) MAX_WINDOW_FACTOR * r->dst_width * r->dst_height;
+  gsize size;
+
+  for (i = 0; i < n; i++)
+    gst_kenburns_roi_add (r, &maps[i], rect, &scale);
+
+  level = (scale >= 2) ? (gint) floor (log (scale) / log (2)) : 0;
+  level = MIN (level, tiles->levels - 1);
+  for (;;) {
+    f = 1 << level;
+    gst_kenburns_tiles_level_size (tiles, level, &width, &height);
+    /* one more pixel of the level on each side for the rounding */
+    x0 = CLAMP ((gint) floor (rect[0] / f) - 1, 0, width - 1);
+    y0 = CLAMP ((gint) floor (rect[1] / f) - 1, 0, height - 1);
+    x1 = CLAMP ((gint) ceil (rect[2] / f) + 1, x0 + 1, width);
+    y1 = CLAMP ((gint) ceil (rect[3] / f) + 1, y0 + 1, height);
+    /* a strong perspective can need a lot of the image at a high
+     * resolution, rather lose detail than use unbounded memory */
+    if ((gint64) (x1 - x0) * (y1 - y0) <= max_area ||
+        level == tiles->levels - 1)
+      break;
+    level++;
+  }
+
+  step = 1;
+  while ((gint64) ((x1 - x0 + step - 1) / step) *
+      ((y1 - y0 + step - 1) / step) > max_area)
+    step++;
+  w = (x1 - x0 + step - 1) / step;
+  h = (y1 - y0 + step - 1) / step;
+
+  if (!kb->have_window || kb->window_rect[0] != level ||
+      kb->window_rect[1] != x0 || kb->window_rect[2] != y0 ||
+      kb->window_rect[3] != x1 || kb->window_rect[4] != y1 ||
+      kb->window_rect[5] != step) {
+    stride = gst_video_format_get_row_stride (tiles->format, 0, w);
+    size = (gsize) stride * h;
+    if (size > kb->window_size) {
+      g_free (kb->window);
+      kb->window = g_malloc (size);
+      kb->window_size = size;
     }
+    gst_kenburns_tiles_read (tiles, level, x0, y0, w, h, step, kb->window,
+        stride);
+    kb->window_rect[0] = level;
+    kb->window_rect[1] = x0;
+    kb->window_rect[2] = y0;
+    kb->window_rect[3] = x1;
+    kb->window_rect[4] = y1;
+    kb->window_rect[5] = step;
+    kb->have_window = TRUE;
   }
+
+  for (i = 0; i < n; i++)
+    gst_kenburns_mapping_crop (&maps[i], x0 * f, y0 * f, 1.0 / (f * step),
+        1.0 / (f * step));
+  r->src_width     = w;
+  r->src_height    = h;
+  r->full_width    = tiles->width;
+  r->full_height   = tiles->height;
+  r->region_x      = x0 * f;
+  r->region_y      = y0 * f;
+  r->region_width  = (x1 - x0) * f;
+  r->region_height = (y1 - y0) * f;
+
+  return kb->window;
 }
 
 static GstFlowReturn
@@ -496,71 +781,58 @@ gst_kenburns_transform (GstBaseTransform * trans, GstBuffer * in,
   GstKenburns *kb = GST_KENBURNS (trans);
   guint8 *dst;
   const guint8 *src;
-  guint8 bgcolor[4]; // background color
-
+  GstKenburnsMapping maps[MAX_MOTION_BLUR_SAMPLES];
+  GstKenburnsRenderer r;
+  GstEvent *roi;
+  gint draft;
+  gint64 t0, t1;
+  gint n;
+
+  GST_KENBURNS_TRACE_FRAME (GST_BUFFER_TIMESTAMP (in));
+  t0 = GST_KENBURNS_TRACE_NOW ();
   src = GST_BUFFER_DATA (in);
   dst = GST_BUFFER_DATA (out);
+  GST_OBJECT_LOCK (kb);
+  kb->syncing = TRUE;
+  GST_OBJECT_UNLOCK (kb);
   gst_object_sync_values (G_OBJECT (kb), GST_BUFFER_TIMESTAMP (in));
   GST_OBJECT_LOCK (kb);
+  kb->syncing = FALSE;
+  gst_kenburns_update_pose (kb, in);
+  draft = gst_kenburns_use_draft (kb) ? kb->draft : 1;
+  if (draft > 1) {
+    gst_kenburns_mapping_setup (&kb->renderer, &kb->render_pose, &maps[0]);
+    n = 1;
+  } else {
+    n = gst_kenburns_setup_mappings (kb, GST_BUFFER_TIMESTAMP (in), maps);
+  }
+  roi = NULL;
+  if (!kb->have_tiles)
+    roi = gst_kenburns_request_region (kb, GST_BUFFER_TIMESTAMP (in), maps, n);
+  /* rendered from a copy, so that the properties can be set meanwhile,
+   * with work buffers only this thread uses */
+  r = kb->renderer;
+  r.scratch = kb->scratch;
+  GST_OBJECT_UNLOCK (kb);
+  GST_KENBURNS_TRACE_SPAN ("setup", t0, "samples", n);
 
-  switch (kb->src_fmt) {
-  case GST_VIDEO_FORMAT_I420:
-    COMP_Y (bgcolor[0], kb->bgcolor[BG_RED], kb->bgcolor[BG_GREEN], kb->bgcolor[BG_BLUE]);
-    COMP_U (bgcolor[1], kb->bgcolor[BG_RED], kb->bgcolor[BG_GREEN], kb->bgcolor[BG_BLUE]);
-    COMP_V (bgcolor[2], kb->bgcolor[BG_RED], kb->bgcolor[BG_GREEN], kb->bgcolor[BG_BLUE]);
-    transform_i420(kb, src, dst, bgcolor);
-    break;
-  case GST_VIDEO_FORMAT_AYUV:
-    bgcolor[0] = kb->bgcolor[BG_ALPHA];
-    COMP_Y (bgcolor[1], kb->bgcolor[BG_RED], kb->bgcolor[BG_GREEN], kb->bgcolor[BG_BLUE]);
-    COMP_U (bgcolor[2], kb->bgcolor[BG_RED], kb->bgcolor[BG_GREEN], kb->bgcolor[BG_BLUE]);
-    COMP_V (bgcolor[3], kb->bgcolor[BG_RED], kb->bgcolor[BG_GREEN], kb->bgcolor[BG_BLUE]);
-    transform_XXXX(kb, src, dst, bgcolor);
-    break;
-  case GST_VIDEO_FORMAT_ARGB:
-  case GST_VIDEO_FORMAT_xRGB:
-    bgcolor[0] = kb->bgcolor[BG_ALPHA];
-    bgcolor[1] = kb->bgcolor[BG_RED];
-    bgcolor[2] = kb->bgcolor[BG_GREEN];
-    bgcolor[3] = kb->bgcolor[BG_BLUE];
-    transform_XXXX(kb, src, dst, bgcolor);
-    break;
-  case GST_VIDEO_FORMAT_ABGR:
-  case GST_VIDEO_FORMAT_xBGR:
-    bgcolor[0] = kb->bgcolor[BG_ALPHA];
-    bgcolor[1] = kb->bgcolor[BG_BLUE];
-    bgcolor[2] = kb->bgcolor[BG_GREEN];
-    bgcolor[3] = kb->bgcolor[BG_RED];
-    transform_XXXX(kb, src, dst, bgcolor);
-    break;
-  case GST_VIDEO_FORMAT_BGRA:
-  case GST_VIDEO_FORMAT_BGRx:
-    bgcolor[0] = kb->bgcolor[BG_BLUE];
-    bgcolor[1] = kb->bgcolor[BG_GREEN];
-    bgcolor[2] = kb->bgcolor[BG_RED];
-    bgcolor[3] = kb->bgcolor[BG_ALPHA];
-    transform_XXXX(kb, src, dst, bgcolor);
-    break;
-  case GST_VIDEO_FORMAT_RGBA:
-  case GST_VIDEO_FORMAT_RGBx:
-    bgcolor[0] = kb->bgcolor[BG_RED];
-    bgcolor[1] = kb->bgcolor[BG_GREEN];
-    bgcolor[2] = kb->bgcolor[BG_BLUE];
-    bgcolor[3] = kb->bgcolor[BG_ALPHA];
-    transform_XXXX(kb, src, dst, bgcolor);
-    break;
-  case GST_VIDEO_FORMAT_BGR:
-    bgcolor[0] = kb->bgcolor[BG_RED];
-    bgcolor[1] = kb->bgcolor[BG_GREEN];
-    bgcolor[2] = kb->bgcolor[BG_RED];
-    transform_XXX(kb, src, dst, bgcolor);
-    break;
-  default:
-    break;
+  if (kb->have_tiles) {
+    t1 = GST_KENBURNS_TRACE_NOW ();
+    src = gst_kenburns_load_window (kb, &r, maps, n);
+    GST_KENBURNS_TRACE_SPAN ("load-window", t1, NULL, 0);
   }
 
-  GST_OBJECT_UNLOCK (kb);
+  t1 = GST_KENBURNS_TRACE_NOW ();
+  if (draft > 1)
+    gst_kenburns_render_draft (&r, &maps[0], draft, src, dst);
+  else
+    gst_kenburns_render (&r, maps, n, src, dst);
+  GST_KENBURNS_TRACE_SPAN ("render", t1, "draft", draft);
+
+  if (roi)
+    gst_pad_push_event (trans->sinkpad, roi);
 
+  GST_KENBURNS_TRACE_SPAN ("frame", t0, NULL, 0);
   return GST_FLOW_OK;
 }
 
@@ -572,40 +844,122 @@ gst_kenburns_set_property (GObject * object, guint prop_id,
 
   switch (prop_id) {
     case PROP_XPOS:
-      kb->xpos = g_value_get_double(value);
+      GST_OBJECT_LOCK (kb);
+      kb->pose.xpos = g_value_get_double(value);
+      gst_kenburns_pose_changed (kb);
+      gst_kenburns_motion_set_defaults (&kb->motion, &kb->pose);
+      GST_OBJECT_UNLOCK (kb);
       break;
     case PROP_YPOS:
-      kb->ypos = g_value_get_double(value);
+      GST_OBJECT_LOCK (kb);
+      kb->pose.ypos = g_value_get_double(value);
+      gst_kenburns_pose_changed (kb);
+      gst_kenburns_motion_set_defaults (&kb->motion, &kb->pose);
+      GST_OBJECT_UNLOCK (kb);
       break;
     case PROP_ZPOS:
-      kb->zpos = g_value_get_double(value);
+      GST_OBJECT_LOCK (kb);
+      kb->pose.zpos = g_value_get_double(value);
+      gst_kenburns_pose_changed (kb);
+      gst_kenburns_motion_set_defaults (&kb->motion, &kb->pose);
+      GST_OBJECT_UNLOCK (kb);
       break;
     case PROP_XROT:
-      kb->xrot = g_value_get_double(value);
+      GST_OBJECT_LOCK (kb);
+      kb->pose.xrot = g_value_get_double(value);
+      gst_kenburns_pose_changed (kb);
+      gst_kenburns_motion_set_defaults (&kb->motion, &kb->pose);
+      GST_OBJECT_UNLOCK (kb);
       break;
     case PROP_YROT:
-      kb->yrot = g_value_get_double(value);
+      GST_OBJECT_LOCK (kb);
+      kb->pose.yrot = g_value_get_double(value);
+      gst_kenburns_pose_changed (kb);
+      gst_kenburns_motion_set_defaults (&kb->motion, &kb->pose);
+      GST_OBJECT_UNLOCK (kb);
       break;
     case PROP_ZROT:
-      kb->zrot = g_value_get_double(value);
+      GST_OBJECT_LOCK (kb);
+      kb->pose.zrot = g_value_get_double(value);
+      gst_kenburns_pose_changed (kb);
+      gst_kenburns_motion_set_defaults (&kb->motion, &kb->pose);
+      GST_OBJECT_UNLOCK (kb);
       break;
     case PROP_FOV:
-      kb->fov = g_value_get_double(value);
+      GST_OBJECT_LOCK (kb);
+      kb->pose.fov = g_value_get_double(value);
+      gst_kenburns_pose_changed (kb);
+      gst_kenburns_motion_set_defaults (&kb->motion, &kb->pose);
+      GST_OBJECT_UNLOCK (kb);
       break;
     case PROP_INTERP_METHOD:
-      kb->interp_method = g_value_get_enum (value);
+      GST_OBJECT_LOCK (kb);
+      kb->renderer.interp_method = g_value_get_enum (value);
+      gst_kenburns_renderer_configure (&kb->renderer);
+      GST_OBJECT_UNLOCK (kb);
       break;
     case PROP_BORDER:
-      kb->border = g_value_get_int(value);
+      GST_OBJECT_LOCK (kb);
+      kb->renderer.border = g_value_get_int(value);
+      gst_kenburns_renderer_configure (&kb->renderer);
+      GST_OBJECT_UNLOCK (kb);
       break;
     case PROP_BGCOLOR:
       { uint tmp = g_value_get_uint(value);
-	kb->bgcolor[BG_ALPHA] = (tmp >> 24) & 0xFF;
-	kb->bgcolor[BG_RED]   = (tmp >> 16) & 0xFF;
-	kb->bgcolor[BG_GREEN] = (tmp >>  8) & 0xFF;
-	kb->bgcolor[BG_BLUE]  = (tmp >>  0) & 0xFF;
+	GST_OBJECT_LOCK (kb);
+	kb->renderer.bgcolor[BG_ALPHA] = (tmp >> 24) & 0xFF;
+	kb->renderer.bgcolor[BG_RED]   = (tmp >> 16) & 0xFF;
+	kb->renderer.bgcolor[BG_GREEN] = (tmp >>  8) & 0xFF;
+	kb->renderer.bgcolor[BG_BLUE]  = (tmp >>  0) & 0xFF;
+	gst_kenburns_renderer_configure (&kb->renderer);
+	GST_OBJECT_UNLOCK (kb);
       }
       break;
+    case PROP_MOTION_PATH:
+      GST_OBJECT_LOCK (kb);
+      if (gst_kenburns_motion_parse (&kb->motion, g_value_get_string (value),
+              &kb->pose)) {
+        g_free (kb->motion_path);
+        kb->motion_path = g_value_dup_string (value);
+        gst_kenburns_pose_changed (kb);
+      } else {
+        GST_WARNING_OBJECT (kb, "Invalid motion path '%s'",
+            g_value_get_string (value));
+      }
+      GST_OBJECT_UNLOCK (kb);
+      break;
+    case PROP_MOTION_EASING:
+      GST_OBJECT_LOCK (kb);
+      kb->motion.easing = g_value_get_enum (value);
+      gst_kenburns_pose_changed (kb);
+      GST_OBJECT_UNLOCK (kb);
+      break;
+    case PROP_MOTION_BLUR_SAMPLES:
+      GST_OBJECT_LOCK (kb);
+      kb->motion_blur_samples = g_value_get_int (value);
+      GST_OBJECT_UNLOCK (kb);
+      break;
+    case PROP_LOCATION:
+      GST_OBJECT_LOCK (kb);
+      g_free (kb->location);
+      kb->location = g_value_dup_string (value);
+      GST_OBJECT_UNLOCK (kb);
+      break;
+    case PROP_TILE_CACHE_SIZE:
+      GST_OBJECT_LOCK (kb);
+      kb->tile_cache_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (kb);
+      break;
+    case PROP_DRAFT:
+      GST_OBJECT_LOCK (kb);
+      kb->draft = g_value_get_int (value);
+      GST_OBJECT_UNLOCK (kb);
+      break;
+    case PROP_DRAFT_IDLE_TIME:
+      GST_OBJECT_LOCK (kb);
+      kb->draft_idle_time = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (kb);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -620,37 +974,64 @@ gst_kenburns_get_property (GObject * object, guint prop_id, GValue * value,
 
   switch (prop_id) {
   case PROP_XPOS:
-    g_value_set_double(value, kb->xpos);
+    g_value_set_double(value, kb->pose.xpos);
     break;
   case PROP_YPOS:
-    g_value_set_double(value, kb->ypos);
+    g_value_set_double(value, kb->pose.ypos);
     break;
   case PROP_ZPOS:
-    g_value_set_double(value, kb->zpos);
+    g_value_set_double(value, kb->pose.zpos);
     break;
   case PROP_XROT:
-    g_value_set_double(value, kb->xrot);
+    g_value_set_double(value, kb->pose.xrot);
     break;
   case PROP_YROT:
-    g_value_set_double(value, kb->yrot);
+    g_value_set_double(value, kb->pose.yrot);
     break;
   case PROP_ZROT:
-    g_value_set_double(value, kb->zrot);
+    g_value_set_double(value, kb->pose.zrot);
     break;
   case PROP_FOV:
-    g_value_set_double(value, kb->fov);
+    g_value_set_double(value, kb->pose.fov);
     break;
   case PROP_INTERP_METHOD:
-    g_value_set_enum(value, kb->interp_method);
+    g_value_set_enum(value, kb->renderer.interp_method);
     break;
   case PROP_BORDER:
-    g_value_set_int(value, kb->border);
+    g_value_set_int(value, kb->renderer.border);
     break;
   case PROP_BGCOLOR:
-    g_value_set_uint(value, ((kb->bgcolor[BG_ALPHA] << 24) |
-			     (kb->bgcolor[BG_RED]   << 16) |
-			     (kb->bgcolor[BG_GREEN] <<  8) |
-			     (kb->bgcolor[BG_BLUE]  <<  0) ));
+    g_value_set_uint(value, ((kb->renderer.bgcolor[BG_ALPHA] << 24) |
+			     (kb->renderer.bgcolor[BG_RED]   << 16) |
+			     (kb->renderer.bgcolor[BG_GREEN] <<  8) |
+			     (kb->renderer.bgcolor[BG_BLUE]  <<  0) ));
+    break;
+  case PROP_MOTION_PATH:
+    GST_OBJECT_LOCK (kb);
+    g_value_set_string(value, kb->motion_path);
+    GST_OBJECT_UNLOCK (kb);
+    break;
+  case PROP_MOTION_EASING:
+    g_value_set_enum(value, kb->motion.easing);
+    break;
+  case PROP_MOTION_BLUR_SAMPLES:
+    GST_OBJECT_LOCK (kb);
+    g_value_set_int(value, kb->motion_blur_samples);
+    GST_OBJECT_UNLOCK (kb);
+    break;
+  case PROP_LOCATION:
+    GST_OBJECT_LOCK (kb);
+    g_value_set_string(value, kb->location);
+    GST_OBJECT_UNLOCK (kb);
+    break;
+  case PROP_TILE_CACHE_SIZE:
+    g_value_set_uint(value, kb->tile_cache_size);
+    break;
+  case PROP_DRAFT:
+    g_value_set_int(value, kb->draft);
+    break;
+  case PROP_DRAFT_IDLE_TIME:
+    g_value_set_uint64(value, kb->draft_idle_time);
     break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -658,6 +1039,19 @@ gst_kenburns_get_property (GObject * object, guint prop_id, GValue * value,
   }
 }
 
+static void
+gst_kenburns_finalize (GObject * object)
+{
+  GstKenburns *kb = GST_KENBURNS (object);
+
+  g_free (kb->motion_path);
+  gst_kenburns_motion_clear (&kb->motion);
+  g_free (kb->location);
+  gst_kenburns_scratch_free (kb->scratch);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_kenburns_base_init (gpointer g_class)
 {
@@ -683,6 +1077,7 @@ gst_kenburns_class_init (GstKenburnsClass * klass)
 
   gobject_class->set_property = gst_kenburns_set_property;
   gobject_class->get_property = gst_kenburns_get_property;
+  gobject_class->finalize     = gst_kenburns_finalize;
 
   g_object_class_install_property (gobject_class, PROP_XPOS,
       g_param_spec_double ("xpos", "x viewing position", "The center of the output viewing port will be placed at this location on the input image. xpos=0.0 corresonds to the center of the input image and 1.0 corresponds to a translation of half an input image width. So 1.0 will center the output on the right side of the image and -1.0 will center it on the left side.",
@@ -721,7 +1116,7 @@ gst_kenburns_class_init (GstKenburnsClass * klass)
 
   g_object_class_install_property (gobject_class, PROP_INTERP_METHOD,
       g_param_spec_enum ("interp-method", "Interpolation method",
-			 "Method for interpolating the output image", 
+			 "Method for interpolating the output image, also used for the motion blur samples",
 			 GST_TYPE_KENBURNS_INTERP_METHOD,
 			 DEFAULT_INTERP_METHOD,
 			 G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
@@ -736,27 +1131,78 @@ gst_kenburns_class_init (GstKenburnsClass * klass)
 			   0, G_MAXUINT32, DEFAULT_BGCOLOR,
 			   G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE));
 
+  g_object_class_install_property (gobject_class, PROP_MOTION_PATH,
+      g_param_spec_string ("motion-path", "Motion path", "Keyframes of the form 't:xpos,ypos,zpos,xrot,yrot,zrot,fov; ...' with t in seconds. The keyframes can be in any order. Empty or trailing fields are carried over from the keyframe before in time, and for the first keyframe from the pose properties, whenever either is set. When at least two keyframes are given, the pose is evaluated from the path for every frame and overrides the individual pose properties.",
+			   DEFAULT_MOTION_PATH,
+			   G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_MOTION_EASING,
+      g_param_spec_enum ("motion-easing", "Motion path easing",
+			 "How the pose moves between the keyframes of the motion path",
+			 GST_TYPE_KENBURNS_EASING,
+			 DEFAULT_MOTION_EASING,
+			 G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_MOTION_BLUR_SAMPLES,
+      g_param_spec_int ("motion-blur-samples", "Motion blur samples", "Maximum number of sub-frame poses averaged together to blur fast motion, each rendered with the interpolation method. The number actually used is reduced to the distance in output pixels the image moves during the frame. 1 disables motion blur.",
+			   1, MAX_MOTION_BLUR_SAMPLES, DEFAULT_MOTION_BLUR_SAMPLES,
+			   G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_LOCATION,
+      g_param_spec_string ("location", "Tiled image location", "Tiled image pyramid to render instead of the input frames, which then only pace the output. Takes effect when the element is started.",
+			   DEFAULT_LOCATION,
+			   G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_TILE_CACHE_SIZE,
+      g_param_spec_uint ("tile-cache-size", "Tile cache size", "Maximum number of tiles of the tiled image kept mapped. Takes effect when the element is started.",
+			   1, G_MAXINT, DEFAULT_TILE_CACHE_SIZE,
+			   G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_DRAFT,
+      g_param_spec_int ("draft", "Draft reduction", "While the application keeps setting the pose properties, motion-path or motion-easing, or doing flushing seeks, render with nearest neighbor interpolation and without motion blur at this fraction of the output resolution, and enlarge the result to the output size. Controllers and the motion path itself do not count. 1 disables drafts. Meant for interactive previews.",
+			   1, MAX_DRAFT, DEFAULT_DRAFT,
+			   G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_DRAFT_IDLE_TIME,
+      g_param_spec_uint64 ("draft-idle-time", "Draft idle time", "Time in nanoseconds the application has to leave the pose, the motion path and the position alone before frames are rendered at full quality again when draft is enabled. The first frame after that is rendered at full quality, no frame is rendered without input.",
+			   0, G_MAXUINT64, DEFAULT_DRAFT_IDLE_TIME,
+			   G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   trans_class->set_caps       = GST_DEBUG_FUNCPTR (gst_kenburns_set_caps);
   trans_class->transform      = GST_DEBUG_FUNCPTR (gst_kenburns_transform);
   trans_class->transform_caps = GST_DEBUG_FUNCPTR (gst_kenburns_transform_caps);
+  trans_class->start          = GST_DEBUG_FUNCPTR (gst_kenburns_start);
+  trans_class->stop           = GST_DEBUG_FUNCPTR (gst_kenburns_stop);
+  trans_class->event          = GST_DEBUG_FUNCPTR (gst_kenburns_event);
+  trans_class->src_event      = GST_DEBUG_FUNCPTR (gst_kenburns_src_event);
 }
 
 static void
 gst_kenburns_init (GstKenburns * kb, GstKenburnsClass * klass)
 {
-  kb->xpos      = DEFAULT_XPOS;
-  kb->ypos      = DEFAULT_YPOS;
-  kb->zpos      = DEFAULT_ZPOS;
-  kb->xrot      = DEFAULT_XROT;
-  kb->yrot      = DEFAULT_YROT;
-  kb->zrot      = DEFAULT_ZROT;
-  kb->interp_method = DEFAULT_INTERP_METHOD;
-  kb->border  = DEFAULT_BORDER;
-  kb->fov     = DEFAULT_FOV;
-  kb->bgcolor[BG_ALPHA] = (DEFAULT_BGCOLOR >> 24) & 0xFF;
-  kb->bgcolor[BG_RED]   = (DEFAULT_BGCOLOR >> 16) & 0xFF;
-  kb->bgcolor[BG_GREEN] = (DEFAULT_BGCOLOR >> 8)  & 0xFF;
-  kb->bgcolor[BG_BLUE]  = (DEFAULT_BGCOLOR >> 0)  & 0xFF;
+  kb->pose.xpos      = DEFAULT_XPOS;
+  kb->pose.ypos      = DEFAULT_YPOS;
+  kb->pose.zpos      = DEFAULT_ZPOS;
+  kb->pose.xrot      = DEFAULT_XROT;
+  kb->pose.yrot      = DEFAULT_YROT;
+  kb->pose.zrot      = DEFAULT_ZROT;
+  kb->renderer.interp_method = DEFAULT_INTERP_METHOD;
+  kb->renderer.border  = DEFAULT_BORDER;
+  kb->pose.fov     = DEFAULT_FOV;
+  kb->renderer.bgcolor[BG_ALPHA] = (DEFAULT_BGCOLOR >> 24) & 0xFF;
+  kb->renderer.bgcolor[BG_RED]   = (DEFAULT_BGCOLOR >> 16) & 0xFF;
+  kb->renderer.bgcolor[BG_GREEN] = (DEFAULT_BGCOLOR >> 8)  & 0xFF;
+  kb->renderer.bgcolor[BG_BLUE]  = (DEFAULT_BGCOLOR >> 0)  & 0xFF;
+  gst_kenburns_renderer_configure (&kb->renderer);
+  kb->scratch = gst_kenburns_scratch_new ();
+  kb->motion_path = DEFAULT_MOTION_PATH;
+  gst_kenburns_motion_init (&kb->motion);
+  kb->motion.easing = DEFAULT_MOTION_EASING;
+  kb->motion_blur_samples = DEFAULT_MOTION_BLUR_SAMPLES;
+  kb->location = DEFAULT_LOCATION;
+  kb->tile_cache_size = DEFAULT_TILE_CACHE_SIZE;
+  kb->draft = DEFAULT_DRAFT;
+  kb->draft_idle_time = DEFAULT_DRAFT_IDLE_TIME;
   gst_base_transform_set_passthrough (GST_BASE_TRANSFORM (kb), FALSE);
 }
 
@@ -775,9 +1221,12 @@ kenburns_init (GstPlugin * kenburns)
   //GST_DEBUG_CATEGORY_INIT (gst_kenburns_debug, "kenburns",
   //    0, "Overlay icons on a video stream and optionally have them blink");
   gst_controller_init (NULL, NULL);
+  gst_kenburns_trace_init ();
 
   return gst_element_register (kenburns, "kenburns", GST_RANK_NONE,
-      GST_TYPE_KENBURNS);
+      GST_TYPE_KENBURNS) &&
+      gst_element_register (kenburns, "kenburnsxfade", GST_RANK_NONE,
+      GST_TYPE_KENBURNS_XFADE);
 }
 
 
@@ -24,6 +24,10 @@
 #include <gst/video/video.h>
 #include <gst/video/gstvideofilter.h>
 
+#include "gstkenburnsmotion.h"
+#include "gstkenburnsrender.h"
+#include "gstkenburnstiles.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_KENBURNS \
@@ -40,16 +44,6 @@ G_BEGIN_DECLS
 typedef struct _GstKenburns GstKenburns;
 typedef struct _GstKenburnsClass GstKenburnsClass;
 
-/**
- * GstKenburnsInterpMethod:
- * @GST_KENBURNS_INTERP_METHOD_NEAREST: uses nearest neighbor interpolation. This is the fastest method but can have aliasing artifacts.
- *
- * Interpolation Method.
- */
-typedef enum {
-  GST_KENBURNS_INTERP_METHOD_NEAREST,
-} GstKenburnsInterpMethod;
-
 /**
  * GstKenburns:
  *
@@ -59,15 +53,55 @@ struct _GstKenburns {
   GstVideoFilter videofilter;
   
   /* < private > */
-  gint32 src_width, src_height;
-  gint32 dst_width, dst_height;
-  gint32 border;
-  GstVideoFormat src_fmt, dst_fmt;
-
-  gdouble zpos, xpos, ypos, xrot, yrot, zrot;
-  gdouble fov;
-  GstKenburnsInterpMethod interp_method;
-  guint32 bgcolor[4];
+  /* formats, sizes and the render settings, see gstkenburnsrender.h, and
+   * the work buffers of the streaming thread */
+  GstKenburnsRenderer renderer;
+  GstKenburnsScratch *scratch;
+
+  gint fps_n, fps_d;
+
+  /* the pose properties, and the pose the current frame is rendered in */
+  GstKenburnsPose pose;
+  GstKenburnsPose render_pose;
+
+  /* built in motion path, evaluated per frame instead of the controllers */
+  gchar *motion_path;
+  GstKenburnsMotion motion;
+
+  /* change of the pose over the current frame period, analytic when a
+   * motion path is active and a backward difference otherwise */
+  GstKenburnsPose pose_delta;
+  GstKenburnsPose prev_pose;
+  gboolean have_prev_pose;
+  gdouble frame_period;
+
+  /* upper bound on the number of sub-frame poses averaged per frame */
+  gint motion_blur_samples;
+
+  /* source region (x0, y0, x1, y1) and reduction last requested upstream */
+  gboolean have_roi;
+  gint roi[4];
+  gdouble roi_scale;
+
+  /* tiled image rendered instead of the input frames, and the part of it
+   * read for the current frame */
+  gchar *location;
+  guint tile_cache_size;
+  gboolean have_tiles;
+  GstKenburnsTiles tiles;
+  guint8 *window;
+  gsize window_size;
+  /* level, x0, y0, x1, y1 and step of the part in window */
+  gboolean have_window;
+  gint window_rect[6];
+
+  /* reduction of the output resolution while the pose is changing, and
+   * the system time the application last changed it, or did a flushing
+   * seek, at. syncing is set while the controllers set the properties. */
+  gint draft;
+  GstClockTime draft_idle_time;
+  GstClockTime last_change;
+  gboolean syncing;
 };
 
 struct _GstKenburnsClass {
@@ -0,0 +1,114 @@
+/* GStreamer
+ * Copyright (C) <2011> Lane Brooks  <dirjud@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Weight tables for the bicubic and lanczos3 interpolation methods.
+ *
+ * Rather than evaluating the kernel for every output pixel, the fractional
+ * part of the source coordinate is quantized to one of
+ * GST_KENBURNS_FILTER_PHASES positions and the weights are looked up. The
+ * tables are small (at most a few kilobytes), so the renderer builds one
+ * per mapping for every frame, in its work buffers, and hands it to the
+ * kernels of all bands of the frame. This also lets the kernel be widened
+ * by the current minification factor to avoid aliasing when zoomed out.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstkenburnsfilter.h"
+
+#include <math.h>
+
+/* Keys cubic convolution kernel with a = -0.5 (Catmull-Rom) */
+static gdouble
+bicubic (gdouble x)
+{
+  const gdouble a = -0.5;
+
+  x = fabs (x);
+  if (x <= 1)
+    return ((a + 2) * x - (a + 3)) * x * x + 1;
+  if (x < 2)
+    return ((a * x - 5 * a) * x + 8 * a) * x - 4 * a;
+  return 0;
+}
+
+static gdouble
+sinc (gdouble x)
+{
+  if (x == 0)
+    return 1;
+  x *= M_PI;
+  return sin (x) / x;
+}
+
+static gdouble
+lanczos3 (gdouble x)
+{
+  if (fabs (x) >= 3)
+    return 0;
+  return sinc (x) * sinc (x / 3);
+}
+
+/* Builds the weight table of the kernel for method, stretched by scale
+ * (the number of source pixels per output pixel, clamped to [1, 8]). */
+void
+gst_kenburns_filter_build (GstKenburnsFilter *filter,
+    GstKenburnsInterpMethod method, gdouble scale)
+{
+  gdouble (*kernel) (gdouble);
+  gdouble radius, frac, sum, w[GST_KENBURNS_FILTER_MAX_TAPS];
+  gint taps, p, j, isum, peak;
+  gint16 *row;
+
+  if (method == GST_KENBURNS_INTERP_METHOD_LANCZOS3) {
+    kernel = lanczos3;
+    radius = 3;
+  } else {
+    kernel = bicubic;
+    radius = 2;
+  }
+  scale = CLAMP (scale, 1.0, GST_KENBURNS_FILTER_MAX_SCALE);
+  taps = 2 * (gint) ceil (radius * scale);
+
+  filter->taps = taps;
+
+  for (p = 0; p < GST_KENBURNS_FILTER_PHASES; p++) {
+    frac = (gdouble) p / GST_KENBURNS_FILTER_PHASES;
+    sum = 0;
+    for (j = 0; j < taps; j++) {
+      w[j] = kernel ((j - taps / 2 + 1 - frac) / scale);
+      sum += w[j];
+    }
+
+    /* normalize, and give the rounding error to the largest weight so the
+     * row sums to exactly one */
+    row = GST_KENBURNS_FILTER_WEIGHTS (filter, p);
+    isum = 0;
+    peak = 0;
+    for (j = 0; j < taps; j++) {
+      row[j] = (gint16) floor (w[j] / sum * GST_KENBURNS_FILTER_ONE + 0.5);
+      isum += row[j];
+      if (row[j] > row[peak])
+        peak = j;
+    }
+    row[peak] += GST_KENBURNS_FILTER_ONE - isum;
+  }
+}
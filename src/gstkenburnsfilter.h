@@ -0,0 +1,60 @@
+/* GStreamer
+ * Copyright (C) <2011> Lane Brooks  <dirjud@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_KENBURNS_FILTER_H__
+#define __GST_KENBURNS_FILTER_H__
+
+#include "gstkenburnsrender.h"
+
+G_BEGIN_DECLS
+
+/* weights are fixed point with this many fractional bits */
+#define GST_KENBURNS_FILTER_BITS   12
+#define GST_KENBURNS_FILTER_ONE    (1 << GST_KENBURNS_FILTER_BITS)
+/* number of quantized sub-pixel positions */
+#define GST_KENBURNS_FILTER_PHASES 64
+/* the kernel is widened by at most this factor when minifying */
+#define GST_KENBURNS_FILTER_MAX_SCALE 8.0
+/* taps of lanczos3 widened the most */
+#define GST_KENBURNS_FILTER_MAX_TAPS (2 * 3 * (gint) GST_KENBURNS_FILTER_MAX_SCALE)
+
+/**
+ * GstKenburnsFilter:
+ *
+ * A resampling kernel tabulated for GST_KENBURNS_FILTER_PHASES sub-pixel
+ * positions. Row p of the table holds the @taps weights to apply to the
+ * source pixels i0 - taps/2 + 1 ... i0 + taps/2 for a sample at position
+ * i0 + p / GST_KENBURNS_FILTER_PHASES (in pixel center coordinates). Each
+ * row sums to GST_KENBURNS_FILTER_ONE.
+ */
+typedef struct _GstKenburnsFilter {
+  gint taps;
+  gint16 weights[GST_KENBURNS_FILTER_PHASES * GST_KENBURNS_FILTER_MAX_TAPS];
+} GstKenburnsFilter;
+
+#define GST_KENBURNS_FILTER_WEIGHTS(f, phase) \
+  ((f)->weights + (phase) * (f)->taps)
+
+void gst_kenburns_filter_build (GstKenburnsFilter *filter,
+                                GstKenburnsInterpMethod method,
+                                gdouble scale);
+
+G_END_DECLS
+
+#endif /* __GST_KENBURNS_FILTER_H__ */
@@ -0,0 +1,264 @@
+/* GStreamer
+ * Copyright (C) <2011> Lane Brooks  <dirjud@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Built in motion paths for the kenburns element.
+ *
+ * A motion path is a list of keyframes of the form
+ *
+ *   "t:xpos,ypos,zpos,xrot,yrot,zrot,fov; t:xpos,ypos,..."
+ *
+ * where t is the buffer timestamp in seconds. The keyframes can be given
+ * in any order. Trailing or empty fields are inherited from the keyframe
+ * before in time, or from the element properties for the first keyframe,
+ * so "0:0,0,1; 5:0.5,0.5,2" is a complete five second pan and zoom. The
+ * inherited fields are resolved again whenever the properties change, so
+ * it does not matter whether the path is set before or after them. The path is evaluated in closed form
+ * for every frame, which avoids attaching a GstController control source
+ * to each of the pose properties, and also yields the exact derivative of
+ * the pose with respect to time.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstkenburnsmotion.h"
+
+#include <string.h>
+
+void
+gst_kenburns_motion_init (GstKenburnsMotion *motion)
+{
+  motion->keyframes = g_array_new (FALSE, TRUE, sizeof (GstKenburnsKeyframe));
+  motion->easing = GST_KENBURNS_EASING_LINEAR;
+}
+
+void
+gst_kenburns_motion_clear (GstKenburnsMotion *motion)
+{
+  if (motion->keyframes)
+    g_array_free (motion->keyframes, TRUE);
+  motion->keyframes = NULL;
+}
+
+gboolean
+gst_kenburns_motion_active (const GstKenburnsMotion *motion)
+{
+  return motion->keyframes && motion->keyframes->len >= 2;
+}
+
+/* Parses a keyframe. The fields that are not given are left for
+ * gst_kenburns_motion_set_defaults(). */
+static gboolean
+parse_keyframe (const gchar *str, GstKenburnsKeyframe *key)
+{
+  gchar **fields, *end;
+  const gchar *colon;
+  gdouble t;
+  guint i, n;
+
+  t = g_ascii_strtod (str, &end);
+  colon = strchr (str, ':');
+  if (end == str || colon == NULL || t < 0)
+    return FALSE;
+  while (*end == ' ' || *end == '\t')
+    end++;
+  if (end != colon)
+    return FALSE;
+
+  key->time = (GstClockTime) (t * GST_SECOND + 0.5);
+  memset (&key->pose, 0, sizeof (key->pose));
+  key->set = 0;
+
+  fields = g_strsplit (colon + 1, ",", -1);
+  n = g_strv_length (fields);
+  if (n > GST_KENBURNS_POSE_N_FIELDS) {
+    g_strfreev (fields);
+    return FALSE;
+  }
+  for (i = 0; i < n; i++) {
+    g_strstrip (fields[i]);
+    if (fields[i][0] == '\0')
+      continue;                 /* inherit */
+    GST_KENBURNS_POSE_FIELD (&key->pose, i) = g_ascii_strtod (fields[i], &end);
+    if (end == fields[i] || *end != '\0') {
+      g_strfreev (fields);
+      return FALSE;
+    }
+    key->set |= 1 << i;
+  }
+  g_strfreev (fields);
+  return TRUE;
+}
+
+/* Fills in the fields the keyframes of motion do not give, from the
+ * keyframe before in time, or from defaults for the first keyframe. */
+void
+gst_kenburns_motion_set_defaults (GstKenburnsMotion *motion,
+    const GstKenburnsPose *defaults)
+{
+  GstKenburnsKeyframe *key;
+  const GstKenburnsPose *prev = defaults;
+  guint i, j;
+
+  for (i = 0; i < motion->keyframes->len; i++) {
+    key = &g_array_index (motion->keyframes, GstKenburnsKeyframe, i);
+    for (j = 0; j < GST_KENBURNS_POSE_N_FIELDS; j++)
+      if (!(key->set & (1 << j)))
+        GST_KENBURNS_POSE_FIELD (&key->pose, j) =
+            GST_KENBURNS_POSE_FIELD (prev, j);
+    prev = &key->pose;
+  }
+}
+
+/* Replaces the keyframes of motion with those described by str. On a parse
+ * error, motion is left untouched and FALSE is returned. An empty or NULL
+ * string clears the path. */
+gboolean
+gst_kenburns_motion_parse (GstKenburnsMotion *motion, const gchar *str,
+    const GstKenburnsPose *defaults)
+{
+  GArray *keyframes;
+  GstKenburnsKeyframe key;
+  gchar **entries;
+  guint i, pos;
+
+  keyframes = g_array_new (FALSE, TRUE, sizeof (GstKenburnsKeyframe));
+  entries = g_strsplit (str ? str : "", ";", -1);
+  for (i = 0; entries[i]; i++) {
+    g_strstrip (entries[i]);
+    if (entries[i][0] == '\0')
+      continue;
+    if (!parse_keyframe (entries[i], &key)) {
+      g_strfreev (entries);
+      g_array_free (keyframes, TRUE);
+      return FALSE;
+    }
+    /* kept sorted by time, keyframes at the same time in text order */
+    for (pos = keyframes->len; pos > 0; pos--)
+      if (g_array_index (keyframes, GstKenburnsKeyframe, pos - 1).time <=
+          key.time)
+        break;
+    g_array_insert_val (keyframes, pos, key);
+  }
+  g_strfreev (entries);
+
+  gst_kenburns_motion_clear (motion);
+  motion->keyframes = keyframes;
+  gst_kenburns_motion_set_defaults (motion, defaults);
+  return TRUE;
+}
+
+/* Returns the eased progress e(u) and its derivative de/du for u in [0,1]. */
+static void
+ease (GstKenburnsEasing easing, gdouble u, gdouble *e, gdouble *de)
+{
+  switch (easing) {
+    case GST_KENBURNS_EASING_IN:
+      *e  = u * u;
+      *de = 2 * u;
+      break;
+    case GST_KENBURNS_EASING_OUT:
+      *e  = u * (2 - u);
+      *de = 2 - 2 * u;
+      break;
+    case GST_KENBURNS_EASING_IN_OUT:
+      *e  = u * u * (3 - 2 * u);
+      *de = 6 * u * (1 - u);
+      break;
+    case GST_KENBURNS_EASING_LINEAR:
+    default:
+      *e  = u;
+      *de = 1;
+      break;
+  }
+}
+
+/* Evaluates the pose and its time derivative (per second) at time t.
+ * Before the first and after the last keyframe the pose is held and the
+ * velocity is zero. */
+void
+gst_kenburns_motion_eval (const GstKenburnsMotion *motion, GstClockTime t,
+    GstKenburnsPose *pose, GstKenburnsPose *velocity)
+{
+  const GstKenburnsKeyframe *keys;
+  const GstKenburnsPose *p0, *p1, *p2, *p3;
+  guint n, lo, hi, mid, i;
+  gdouble u, dt, e, de;
+
+  g_return_if_fail (gst_kenburns_motion_active (motion));
+
+  keys = (const GstKenburnsKeyframe *) motion->keyframes->data;
+  n = motion->keyframes->len;
+  memset (velocity, 0, sizeof (*velocity));
+
+  if (t <= keys[0].time) {
+    *pose = keys[0].pose;
+    return;
+  }
+  if (t >= keys[n - 1].time) {
+    *pose = keys[n - 1].pose;
+    return;
+  }
+
+  /* find the segment such that keys[lo].time <= t < keys[lo+1].time */
+  lo = 0;
+  hi = n - 1;
+  while (hi - lo > 1) {
+    mid = (lo + hi) / 2;
+    if (keys[mid].time <= t)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  dt = (gdouble) (keys[hi].time - keys[lo].time) / GST_SECOND;
+  u  = (gdouble) (t - keys[lo].time) / GST_SECOND / dt;
+  p1 = &keys[lo].pose;
+  p2 = &keys[hi].pose;
+
+  if (motion->easing == GST_KENBURNS_EASING_SPLINE) {
+    /* Catmull-Rom, with the end keyframes repeated as tangent handles */
+    p0 = &keys[lo > 0 ? lo - 1 : lo].pose;
+    p3 = &keys[hi < n - 1 ? hi + 1 : hi].pose;
+    for (i = 0; i < GST_KENBURNS_POSE_N_FIELDS; i++) {
+      gdouble a = GST_KENBURNS_POSE_FIELD (p0, i);
+      gdouble b = GST_KENBURNS_POSE_FIELD (p1, i);
+      gdouble c = GST_KENBURNS_POSE_FIELD (p2, i);
+      gdouble d = GST_KENBURNS_POSE_FIELD (p3, i);
+      gdouble c1 = c - a;
+      gdouble c2 = 2 * a - 5 * b + 4 * c - d;
+      gdouble c3 = -a + 3 * b - 3 * c + d;
+
+      GST_KENBURNS_POSE_FIELD (pose, i) =
+          b + 0.5 * u * (c1 + u * (c2 + u * c3));
+      GST_KENBURNS_POSE_FIELD (velocity, i) =
+          0.5 * (c1 + u * (2 * c2 + u * 3 * c3)) / dt;
+    }
+  } else {
+    ease (motion->easing, u, &e, &de);
+    for (i = 0; i < GST_KENBURNS_POSE_N_FIELDS; i++) {
+      gdouble b = GST_KENBURNS_POSE_FIELD (p1, i);
+      gdouble c = GST_KENBURNS_POSE_FIELD (p2, i);
+
+      GST_KENBURNS_POSE_FIELD (pose, i) = b + (c - b) * e;
+      GST_KENBURNS_POSE_FIELD (velocity, i) = (c - b) * de / dt;
+    }
+  }
+}
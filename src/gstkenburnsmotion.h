@@ -0,0 +1,93 @@
+/* GStreamer
+ * Copyright (C) <2011> Lane Brooks  <dirjud@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_KENBURNS_MOTION_H__
+#define __GST_KENBURNS_MOTION_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstKenburnsPose:
+ *
+ * The viewing parameters of the kenburns element. The fields are all
+ * doubles and are laid out back to back so that they can be treated as
+ * an array of GST_KENBURNS_POSE_N_FIELDS values when interpolating.
+ */
+typedef struct {
+  gdouble xpos, ypos, zpos;
+  gdouble xrot, yrot, zrot;
+  gdouble fov;
+} GstKenburnsPose;
+
+#define GST_KENBURNS_POSE_N_FIELDS 7
+#define GST_KENBURNS_POSE_FIELD(pose, i) (((gdouble *) (pose))[i])
+
+/**
+ * GstKenburnsEasing:
+ * @GST_KENBURNS_EASING_LINEAR: constant speed between keyframes.
+ * @GST_KENBURNS_EASING_IN: start slow and accelerate into the next keyframe.
+ * @GST_KENBURNS_EASING_OUT: start fast and decelerate into the next keyframe.
+ * @GST_KENBURNS_EASING_IN_OUT: accelerate then decelerate (smoothstep).
+ * @GST_KENBURNS_EASING_SPLINE: Catmull-Rom spline through all keyframes.
+ *
+ * How the pose moves between two keyframes of a motion path.
+ */
+typedef enum {
+  GST_KENBURNS_EASING_LINEAR,
+  GST_KENBURNS_EASING_IN,
+  GST_KENBURNS_EASING_OUT,
+  GST_KENBURNS_EASING_IN_OUT,
+  GST_KENBURNS_EASING_SPLINE,
+} GstKenburnsEasing;
+
+typedef struct {
+  GstClockTime time;
+  GstKenburnsPose pose;
+  guint set;                    /* bit i is set when the path gives field i */
+} GstKenburnsKeyframe;
+
+/**
+ * GstKenburnsMotion:
+ *
+ * A motion path: a time sorted list of keyframes and the easing used to
+ * move between them. A path with less than two keyframes is inactive.
+ */
+typedef struct {
+  GArray *keyframes;
+  GstKenburnsEasing easing;
+} GstKenburnsMotion;
+
+void     gst_kenburns_motion_init   (GstKenburnsMotion *motion);
+void     gst_kenburns_motion_clear  (GstKenburnsMotion *motion);
+gboolean gst_kenburns_motion_parse  (GstKenburnsMotion *motion,
+                                     const gchar *str,
+                                     const GstKenburnsPose *defaults);
+void     gst_kenburns_motion_set_defaults (GstKenburnsMotion *motion,
+                                           const GstKenburnsPose *defaults);
+gboolean gst_kenburns_motion_active (const GstKenburnsMotion *motion);
+void     gst_kenburns_motion_eval   (const GstKenburnsMotion *motion,
+                                     GstClockTime t,
+                                     GstKenburnsPose *pose,
+                                     GstKenburnsPose *velocity);
+
+G_END_DECLS
+
+#endif /* __GST_KENBURNS_MOTION_H__ */
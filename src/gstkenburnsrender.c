@@ -0,0 +1,1865 @@
+/* GStreamer
+ * Copyright (C) <2011> Lane Brooks  <dirjud@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Render kernels of the kenburns elements.
+ *
+ * Each kernel is written once as an always inlined "template" function
+ * whose pixel layout, rotation, border and blend arguments are compile
+ * time constants in the small wrappers generated further down. The compiler
+ * therefore emits one straight-line inner loop per combination, with the
+ * pixel copies reduced to fixed size moves and the border handling
+ * compiled out when there is no border. gst_kenburns_renderer_configure()
+ * looks the wrappers up in a table whenever the caps or the relevant
+ * properties change, so the per frame dispatch is a single indirect call.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstkenburnsrender.h"
+#include "gstkenburnsfilter.h"
+#include "gstkenburnstrace.h"
+
+#include <string.h>
+#include <math.h>
+
+#ifdef __GNUC__
+#define KB_TEMPLATE static inline __attribute__ ((always_inline)) void
+#else
+#define KB_TEMPLATE static inline void
+#endif
+
+#define COMP_Y(ret, r, g, b) \
+{ \
+   ret = (int) (((19595 * r) >> 16) + ((38470 * g) >> 16) + ((7471 * b) >> 16)); \
+   ret = CLAMP (ret, 0, 255); \
+}
+
+#define COMP_U(ret, r, g, b) \
+{ \
+   ret = (int) (-((11059 * r) >> 16) - ((21709 * g) >> 16) + ((32768 * b) >> 16) + 128); \
+   ret = CLAMP (ret, 0, 255); \
+}
+
+#define COMP_V(ret, r, g, b) \
+{ \
+   ret = (int) (((32768 * r) >> 16) - ((27439 * g) >> 16) - ((5329 * b) >> 16) + 128); \
+   ret = CLAMP (ret, 0, 255); \
+}
+
+/* the inverse of COMP_Y, COMP_U and COMP_V */
+#define COMP_R(ret, y, u, v) \
+{ \
+   ret = (int) (y + ((91881 * (v - 128)) >> 16)); \
+   ret = CLAMP (ret, 0, 255); \
+}
+
+#define COMP_G(ret, y, u, v) \
+{ \
+   ret = (int) (y - ((22554 * (u - 128)) >> 16) - ((46802 * (v - 128)) >> 16)); \
+   ret = CLAMP (ret, 0, 255); \
+}
+
+#define COMP_B(ret, y, u, v) \
+{ \
+   ret = (int) (y + ((116130 * (u - 128)) >> 16)); \
+   ret = CLAMP (ret, 0, 255); \
+}
+
+GType
+gst_kenburns_interp_method_get_type (void)
+{
+  static GType kenburns_interp_method_type = 0;
+  static const GEnumValue kenburns_interp_method[] = {
+    {GST_KENBURNS_INTERP_METHOD_NEAREST, "nearest", "nearest"},
+    {GST_KENBURNS_INTERP_METHOD_BICUBIC, "bicubic", "bicubic"},
+    {GST_KENBURNS_INTERP_METHOD_LANCZOS3, "lanczos3", "lanczos3"},
+    {0, NULL, NULL},
+  };
+
+  if (!kenburns_interp_method_type) {
+    kenburns_interp_method_type =
+        g_enum_register_static ("GstKenburnsInterpType", kenburns_interp_method);
+  }
+  return kenburns_interp_method_type;
+}
+
+/* Work buffers of the kernels. They are grown on demand and kept until
+ * they are freed, and shared with the copies of the renderer made for
+ * bands and drafts, so that rendering a steady stream of frames allocates
+ * nothing. Each slot has a single user at a time, and the buffers belong
+ * to the thread that renders: the elements configure their renderers
+ * without them and set their own on the copy they render with. */
+enum {
+  SCRATCH_NN_XOFF,
+  SCRATCH_BLUR_SX,
+  SCRATCH_BLUR_SY,
+  SCRATCH_BLUR_ACC,
+  SCRATCH_FILTER_XOFF,
+  SCRATCH_FILTER_XW,
+  SCRATCH_FILTER_YFIRST,
+  SCRATCH_FILTER_YW,
+  SCRATCH_FILTER_RING,
+  SCRATCH_FILTERS,
+  SCRATCH_CONVERT,
+  SCRATCH_DRAFT,
+  N_SCRATCH
+};
+
+struct _GstKenburnsScratch {
+  gpointer data[N_SCRATCH];
+  gsize size[N_SCRATCH];
+};
+
+static gpointer
+scratch_get (const GstKenburnsRenderer *r, gint slot, gsize size) {
+  GstKenburnsScratch *scratch = r->scratch;
+
+  if (size > scratch->size[slot]) {
+    g_free (scratch->data[slot]);
+    scratch->data[slot] = g_malloc (size);
+    scratch->size[slot] = size;
+  }
+  return scratch->data[slot];
+}
+
+/* Work buffers for one rendering thread, to set as the scratch of the
+ * renderers it renders with. */
+GstKenburnsScratch *
+gst_kenburns_scratch_new (void)
+{
+  return g_new0 (GstKenburnsScratch, 1);
+}
+
+void
+gst_kenburns_scratch_free (GstKenburnsScratch * scratch)
+{
+  gint i;
+
+  if (scratch == NULL)
+    return;
+  for (i = 0; i < N_SCRATCH; i++)
+    g_free (scratch->data[i]);
+  g_free (scratch);
+}
+
+void
+gst_kenburns_mapping_setup (const GstKenburnsRenderer * r,
+    const GstKenburnsPose * pose, GstKenburnsMapping * m)
+{
+  double src_aspect_ratio, dst_aspect_ratio;
+  FRAC tan_thetax, wsrc, hsrc, wlb, hlb;
+  gint32 full_width = r->src_width, full_height = r->src_height;
+
+  /* the letterbox is worked out on the full image, and the coordinates are
+   * moved into the cropped or reduced frames at the end */
+  if (r->region_width > 0 && r->region_height > 0) {
+    full_width  = r->full_width;
+    full_height = r->full_height;
+  }
+
+  src_aspect_ratio  = full_width / (double) full_height;
+  dst_aspect_ratio  = r->dst_width / (double) r->dst_height;
+  /* calculate letterbox width and height based on output aspect ratio */
+  if(src_aspect_ratio > dst_aspect_ratio) {
+    wlb  = INT2FRAC(full_width);  /* letterbox width */
+    wsrc = wlb;                          /* actual width is the same */
+    hlb  = wlb * r->dst_height / r->dst_width; /* letterbox height */
+    hsrc = INT2FRAC(full_height);  /* actual height */
+  } else {
+    hlb  = INT2FRAC(full_height);
+    hsrc = hlb;
+    wlb  = hlb * r->dst_width / r->dst_height;
+    wsrc = INT2FRAC(full_width);
+  }
+  m->zoomx = wlb / r->dst_width;
+  m->zoomy = hlb / r->dst_height;
+
+  m->cos_thetax = DBL2FRAC(cos(pose->xrot*M_PI/180));
+  m->sin_thetax = DBL2FRAC(sin(pose->xrot*M_PI/180));
+  tan_thetax    = DBL2FRAC(tan(pose->xrot*M_PI/180));
+  m->cos_thetay = DBL2FRAC(cos(pose->yrot*M_PI/180));
+  m->sin_thetay = DBL2FRAC(sin(pose->yrot*M_PI/180));
+  m->tan_thetay = DBL2FRAC(tan(pose->yrot*M_PI/180));
+  m->cos_thetaz = DBL2FRAC(cos(pose->zrot*M_PI/180));
+  m->sin_thetaz = DBL2FRAC(sin(pose->zrot*M_PI/180));
+  if(m->cos_thetay == 0) { m->cos_thetay= INC_FROM_ZERO; }
+  m->tan_thetax_on_cos_thetay = FRAC_DIV(tan_thetax,m->cos_thetay);
+
+  m->xd0 = DBL2FRAC(0.5 + r->dst_width  * (pose->xpos/2/pose->zpos - 0.5));
+  m->yd0 = DBL2FRAC(0.5 + r->dst_height * (pose->ypos/2/pose->zpos - 0.5));
+  m->xs3 = ((FRAC) (wsrc / pose->zpos)) / 2;
+  m->ys3 = ((FRAC) (hsrc / pose->zpos)) / 2;
+  m->zposx = DBL2FRAC(pose->zpos);
+  m->zposy = DBL2FRAC(pose->zpos);
+
+  /* z1 is the distance is pixels required for the requested fov to see get
+     the letterbox image perfectly framed.*/
+  m->z1 = (FRAC) (((wlb > hlb) ? wlb : hlb) / 2 / tan(pose->fov / 2 / 180 * M_PI));
+
+  m->rotate = (pose->xrot || pose->yrot || pose->zrot);
+
+  if (r->region_width > 0 && r->region_height > 0)
+    gst_kenburns_mapping_crop (m, r->region_x, r->region_y,
+        r->src_width / r->region_width, r->src_height / r->region_height);
+}
+
+/* Moves a mapping into a frame whose pixel (0, 0) is at (x, y) of the image
+ * the mapping was set up for, and which has sx by sy frame pixels per image
+ * pixel. */
+void
+gst_kenburns_mapping_crop (GstKenburnsMapping * m, gdouble x, gdouble y,
+    gdouble sx, gdouble sy)
+{
+  m->xs3 -= DBL2FRAC(x) / m->zposx;
+  m->ys3 -= DBL2FRAC(y) / m->zposy;
+  m->zposx *= sx;
+  m->zposy *= sy;
+}
+
+// This is when no rotation is used, it avoids a lot of calculations and
+// is therefore faster.
+#define TRANSLATE(m, xsrc, ysrc, xdst, ydst) \
+  {   \
+      FRAC x0, y0;	\
+      \
+      /* translate dest image coordinates to input image coordinates	\
+         (0,0) at the center of the input image */			\
+      x0 = FRAC_MULT ((INT2FRAC (xdst) + (m)->xd0 ), (m)->zoomx);	\
+      y0 = FRAC_MULT ((INT2FRAC (ydst) + (m)->yd0 ), (m)->zoomy);	\
+      \
+      /* perform zoom and translation and then translate back to (0,0) in
+         the upper left corner */    \
+      xsrc = FRAC_MULT ((x0 + (m)->xs3), (m)->zposx);	   \
+      ysrc = FRAC_MULT ((y0 + (m)->ys3), (m)->zposy);	   \
+  }
+
+// This is what we use when a rotation is requested.
+#define TRANSFORM(m, xsrc, ysrc, xdst, ydst) \
+  {   \
+      FRAC x0, y0, x1, y1, x2, y2, z2, x3, y3, det;	\
+      \
+      /* translate dest image coordinates to input image coordinates	\
+         (0,0) at the center of the input image */			\
+      x0 = FRAC_MULT ((INT2FRAC (xdst) + (m)->xd0 ), (m)->zoomx);	\
+      y0 = FRAC_MULT ((INT2FRAC (ydst) + (m)->yd0 ), (m)->zoomy);	\
+      \
+      /* do the z-axis rotation first because it is easiest */	\
+      x1 =  FRAC_MULT(x0, (m)->cos_thetaz) - FRAC_MULT(y0, (m)->sin_thetaz); \
+      y1 =  FRAC_MULT(x0, (m)->sin_thetaz) + FRAC_MULT(y0, (m)->cos_thetaz); \
+      \
+      /* now find where the x/y axis rotations intersect the current ray \
+	 of vision. */ \
+      det = FRAC_MULT(-x1, (m)->tan_thetax_on_cos_thetay) + FRAC_MULT(y1, (m)->tan_thetay) + (m)->z1; \
+      if( det == 0) { det = INC_FROM_ZERO; } \
+      x2 = FRAC_DIV(FRAC_MULT(x1, (m)->z1), det); \
+      y2 = FRAC_DIV(FRAC_MULT(y1, (m)->z1), det); \
+      z2 = FRAC_DIV(FRAC_MULT((m)->z1, (m)->z1), det) - (m)->z1; \
+      \
+      /* rotate back to source image plane */		\
+      x3 =  FRAC_MULT(x2, (m)->cos_thetax) + FRAC_MULT(FRAC_MULT(y2, (m)->sin_thetay), (m)->sin_thetax) + FRAC_MULT(FRAC_MULT(z2, (m)->cos_thetay), (m)->sin_thetax); \
+      y3 =  FRAC_MULT(y2, (m)->cos_thetay) - FRAC_MULT(z2, (m)->sin_thetay); \
+      \
+      /* perform zoom and translation and then translate back to (0,0) in
+         the upper left corner */    \
+      xsrc = FRAC_MULT ((x3 + (m)->xs3), (m)->zposx);	   \
+      ysrc = FRAC_MULT ((y3 + (m)->ys3), (m)->zposy);	   \
+  }
+
+/* Maps a destination pixel position to the source image. Pixel i covers
+ * [i, i+1) in both images. */
+void
+gst_kenburns_mapping_apply (const GstKenburnsMapping * m, gdouble xdst,
+    gdouble ydst, gdouble * xsrc, gdouble * ysrc)
+{
+  FRAC xsrc0, ysrc0;
+
+  if (m->rotate) {
+    TRANSFORM (m, xsrc0, ysrc0, xdst, ydst);
+  } else {
+    TRANSLATE (m, xsrc0, ysrc0, xdst, ydst);
+  }
+  *xsrc = xsrc0;
+  *ysrc = ysrc0;
+}
+
+/* Finds the part of the full source image that rendering with m reads,
+ * as rect = (x0, y0, x1, y1) in full image pixels including the reach of
+ * the interpolation kernel, and the smallest number of full image pixels
+ * per destination pixel over it. The mapping is sampled on a grid across
+ * the destination, which bounds it well as long as the image plane does
+ * not turn away from the viewer. */
+void
+gst_kenburns_mapping_bounds (const GstKenburnsRenderer * r,
+    const GstKenburnsMapping * m, gdouble rect[4], gdouble * scale)
+{
+  const int steps = 8;
+  gdouble full_width = r->src_width, full_height = r->src_height;
+  gdouble region_x = 0, region_y = 0, region_sx = 1, region_sy = 1;
+  gdouble xd, yd, xs, ys, xs1, ys1, s, frame_scale, margin;
+  int i, j, radius;
+
+  if (r->region_width > 0 && r->region_height > 0) {
+    full_width  = r->full_width;
+    full_height = r->full_height;
+    region_x    = r->region_x;
+    region_y    = r->region_y;
+    region_sx   = r->region_width  / r->src_width;
+    region_sy   = r->region_height / r->src_height;
+  }
+
+  rect[0] = rect[1] = G_MAXDOUBLE;
+  rect[2] = rect[3] = -G_MAXDOUBLE;
+  *scale = G_MAXDOUBLE;
+  for(j=0; j <= steps; j++) {
+    for(i=0; i <= steps; i++) {
+      xd = (gdouble) i * r->dst_width  / steps;
+      yd = (gdouble) j * r->dst_height / steps;
+      gst_kenburns_mapping_apply (m, xd, yd, &xs, &ys);
+      xs = region_x + xs * region_sx;
+      ys = region_y + ys * region_sy;
+      rect[0] = MIN (rect[0], xs);
+      rect[1] = MIN (rect[1], ys);
+      rect[2] = MAX (rect[2], xs);
+      rect[3] = MAX (rect[3], ys);
+
+      /* footprint of one destination pixel */
+      gst_kenburns_mapping_apply (m, xd + 1, yd, &xs1, &ys1);
+      s = hypot (region_x + xs1 * region_sx - xs,
+		 region_y + ys1 * region_sy - ys);
+      *scale = MIN (*scale, s);
+      gst_kenburns_mapping_apply (m, xd, yd + 1, &xs1, &ys1);
+      s = hypot (region_x + xs1 * region_sx - xs,
+		 region_y + ys1 * region_sy - ys);
+      *scale = MIN (*scale, s);
+    }
+  }
+
+  switch (r->interp_method) {
+  case GST_KENBURNS_INTERP_METHOD_LANCZOS3:
+    radius = 3;
+    break;
+  case GST_KENBURNS_INTERP_METHOD_BICUBIC:
+    radius = 2;
+    break;
+  default:
+    radius = 1;
+    break;
+  }
+  /* the kernel reach is in pixels of the frames, and it reaches as far in
+   * chroma pixels as in luma pixels */
+  frame_scale = MAX (region_sx, region_sy);
+  margin = (radius * CLAMP (*scale / frame_scale, 1.0, GST_KENBURNS_FILTER_MAX_SCALE) + 1) *
+      frame_scale * ((r->src_fmt == GST_VIDEO_FORMAT_I420) ? 2 : 1);
+  rect[0] = CLAMP (rect[0] - margin, 0, full_width);
+  rect[1] = CLAMP (rect[1] - margin, 0, full_height);
+  rect[2] = CLAMP (rect[2] + margin, 0, full_width);
+  rect[3] = CLAMP (rect[3] + margin, 0, full_height);
+}
+
+/* The images are handled as one or more planes. A plane holds channels
+ * interleaved bytes per pixel and is subsampled by sub relative to the
+ * luma coordinates the mapping works in. Only the plane rows [row0, row1)
+ * are rendered, and when blending they are mixed into the destination
+ * with weight out of 256. */
+typedef struct {
+  const guint8 *src;
+  gint src_stride, src_width, src_height;
+  guint8 *dst;
+  gint dst_stride, dst_width, dst_height;
+  gint channels, sub;
+  gint row0, row1;
+  gint weight;
+  const guint8 *bg;
+} GstKenburnsPlane;
+
+/* Describes the planes of the source and destination buffers for the luma
+ * rows [y0, y1), y0 being even. Returns the number of planes. */
+static int
+setup_planes (const GstKenburnsRenderer *r, const guint8 *src, guint8 *dst,
+	      gint y0, gint y1, gint weight, GstKenburnsPlane *planes) {
+  int i, nplanes = (r->src_fmt == GST_VIDEO_FORMAT_I420) ? 3 : 1;
+
+  for(i=0; i < nplanes; i++) {
+    GstKenburnsPlane *p = &planes[i];
+
+    p->src = src + gst_video_format_get_component_offset(r->src_fmt, i, r->src_width, r->src_height);
+    p->dst = dst + gst_video_format_get_component_offset(r->dst_fmt, i, r->dst_width, r->dst_height);
+    p->src_stride = gst_video_format_get_row_stride(r->src_fmt, i, r->src_width);
+    p->dst_stride = gst_video_format_get_row_stride(r->dst_fmt, i, r->dst_width);
+    p->bg = r->bg + i;
+    if (nplanes == 1) {
+      /* packed, all the bytes of the pixel are handled together */
+      p->src = src;
+      p->dst = dst;
+      p->channels = gst_video_format_get_pixel_stride(r->src_fmt, 0);
+      p->sub = 1;
+    } else {
+      p->channels = 1;
+      p->sub = (i == 0) ? 1 : 2;
+    }
+    p->src_width  = (r->src_width  + p->sub - 1) / p->sub;
+    p->src_height = (r->src_height + p->sub - 1) / p->sub;
+    p->dst_width  = (r->dst_width  + p->sub - 1) / p->sub;
+    p->dst_height = (r->dst_height + p->sub - 1) / p->sub;
+    p->row0 = y0 / p->sub;
+    p->row1 = MIN ((y1 + p->sub - 1) / p->sub, p->dst_height);
+    p->weight = weight;
+  }
+  return nplanes;
+}
+
+/* The range [*x0, *x1) of luma destination columns (or rows) that are not
+ * part of the border. */
+#define BORDER_RANGE(border, size, x0, x1) \
+  { \
+      x0 = MIN ((border), (size)); \
+      x1 = MAX ((size) - (border), x0); \
+  }
+
+/* Mixes s into d with weight out of 256 */
+#define BLEND(d, s, weight) (((d) * (256 - (weight)) + (s) * (weight) + 128) >> 8)
+
+/* Stores a pixel, or blends it into the destination for the second image
+ * of a crossfade. */
+KB_TEMPLATE
+put_pixel (guint8 *out, const guint8 *pix, const int bpp, const gint weight,
+	   const gboolean blend) {
+  int c;
+
+  if (blend) {
+    for(c=0; c < bpp; c++)
+      out[c] = BLEND (out[c], pix[c], weight);
+  } else {
+    memcpy (out, pix, bpp);
+  }
+}
+
+KB_TEMPLATE
+fill_span (guint8 *out, int x0, int x1, const guint8 *bg, const int bpp) {
+  int x;
+
+  for(x=x0; x < x1; x++)
+    memcpy (out + x*bpp, bg, bpp);
+}
+
+/* Puts the background of plane p over a span */
+KB_TEMPLATE
+put_span (guint8 *out, int x0, int x1, const GstKenburnsPlane *p,
+	  const int bpp, const gboolean blend) {
+  int x;
+
+  if (!blend) {
+    fill_span (out, x0, x1, p->bg, bpp);
+    return;
+  }
+  for(x=x0; x < x1; x++)
+    put_pixel (out + x*bpp, p->bg, bpp, p->weight, TRUE);
+}
+
+/*
+ * Nearest neighbor
+ *
+ * A plane pixel takes the value of the source pixel under the last luma
+ * pixel it covers, which matches what writing every luma pixel of a
+ * subsampled block in raster order would leave behind.
+ */
+
+#define NN_REP(c, sub, size) MIN ((c) * (sub) + (sub) - 1, (size) - 1)
+
+/* Without rotation the source column only depends on the destination
+ * column, and it is monotonic in it. The byte offsets of the source
+ * columns are tabulated once per frame, and the destination columns that
+ * land inside the source and outside the border form one contiguous range
+ * [*xa, *xb); every other column is background. */
+static void
+nn_columns (const GstKenburnsRenderer *r, const GstKenburnsMapping *m,
+	    const GstKenburnsPlane *p, int lx0, int lx1,
+	    int *xoff, int *xa, int *xb) {
+  FRAC xsrc0, ysrc0;
+  int c, lx, xsrc;
+
+  *xa = *xb = p->dst_width;
+  for(c=0; c < p->dst_width; c++) {
+    lx = NN_REP (c, p->sub, r->dst_width);
+    TRANSLATE (m, xsrc0, ysrc0, lx, 0);
+    xsrc = FLOOR_FRAC(xsrc0);
+    xoff[c] = CLAMP (xsrc, 0, r->src_width - 1) / p->sub * p->channels;
+    if (lx < lx0 || lx >= lx1 || xsrc < 0 || xsrc >= r->src_width)
+      continue;
+    if (*xa == p->dst_width)
+      *xa = c;
+    *xb = c + 1;
+  }
+  (void) ysrc0;
+}
+
+/* Returns the source row of plane row c, or -1 for a background row. */
+static inline int
+nn_row (const GstKenburnsRenderer *r, const GstKenburnsMapping *m,
+	const GstKenburnsPlane *p, int ly0, int ly1, int c) {
+  FRAC xsrc0, ysrc0;
+  int ly, ysrc;
+
+  ly = NN_REP (c, p->sub, r->dst_height);
+  if (ly < ly0 || ly >= ly1)
+    return -1;
+  TRANSLATE (m, xsrc0, ysrc0, 0, ly);
+  ysrc = FLOOR_FRAC(ysrc0);
+  (void) xsrc0;
+  if (ysrc < 0 || ysrc >= r->src_height)
+    return -1;
+  return ysrc / p->sub;
+}
+
+KB_TEMPLATE
+nn_translate_plane (const GstKenburnsRenderer *r, const GstKenburnsMapping *m,
+		    const GstKenburnsPlane *p, const int bpp,
+		    const gboolean border, const gboolean blend) {
+  int *xoff, xa, xb, c, ysrc, x;
+  int lx0 = 0, lx1 = r->dst_width, ly0 = 0, ly1 = r->dst_height;
+  const guint8 *row;
+  guint8 *out;
+
+  if (border) {
+    BORDER_RANGE (r->border, r->dst_width, lx0, lx1);
+    BORDER_RANGE (r->border, r->dst_height, ly0, ly1);
+  }
+
+  xoff = scratch_get (r, SCRATCH_NN_XOFF, p->dst_width * sizeof (int));
+  nn_columns (r, m, p, lx0, lx1, xoff, &xa, &xb);
+
+  for(c=p->row0; c < p->row1; c++) {
+    out = p->dst + c * p->dst_stride;
+    ysrc = nn_row (r, m, p, ly0, ly1, c);
+    if (ysrc < 0) {
+      put_span (out, 0, p->dst_width, p, bpp, blend);
+      continue;
+    }
+    row = p->src + ysrc * p->src_stride;
+    put_span (out, 0, xa, p, bpp, blend);
+    for(x=xa; x < xb; x++)
+      put_pixel (out + x*bpp, row + xoff[x], bpp, p->weight, blend);
+    put_span (out, xb, p->dst_width, p, bpp, blend);
+  }
+}
+
+/* With rotation every pixel is mapped on its own. */
+KB_TEMPLATE
+nn_rotate_plane (const GstKenburnsRenderer *r, const GstKenburnsMapping *m,
+		 const GstKenburnsPlane *p, const int bpp,
+		 const gboolean border, const gboolean blend) {
+  FRAC xsrc0, ysrc0;
+  int xp, yp, xsrc, ysrc, x0 = 0, x1 = p->dst_width;
+  int lx0 = 0, lx1 = r->dst_width, ly0 = 0, ly1 = r->dst_height;
+  guint8 *out;
+
+  if (border) {
+    BORDER_RANGE (r->border, r->dst_width, lx0, lx1);
+    BORDER_RANGE (r->border, r->dst_height, ly0, ly1);
+    /* plane columns whose representative luma column is not border */
+    x0 = x1 = p->dst_width;
+    for(xp=0; xp < p->dst_width; xp++) {
+      int lx = NN_REP (xp, p->sub, r->dst_width);
+      if (lx >= lx0 && x0 == p->dst_width)
+	x0 = xp;
+      if (lx >= lx1) {
+	x1 = xp;
+	break;
+      }
+    }
+  }
+
+  for(yp=p->row0; yp < p->row1; yp++) {
+    int ly = NN_REP (yp, p->sub, r->dst_height);
+
+    out = p->dst + yp * p->dst_stride;
+    if (border && (ly < ly0 || ly >= ly1)) {
+      put_span (out, 0, p->dst_width, p, bpp, blend);
+      continue;
+    }
+    if (border) {
+      put_span (out, 0, x0, p, bpp, blend);
+      put_span (out, x1, p->dst_width, p, bpp, blend);
+    }
+    for(xp=x0; xp < x1; xp++) {
+      TRANSFORM (m, xsrc0, ysrc0, NN_REP (xp, p->sub, r->dst_width), ly);
+      xsrc = FLOOR_FRAC(xsrc0);
+      ysrc = FLOOR_FRAC(ysrc0);
+      if (xsrc < 0 || xsrc >= r->src_width || ysrc < 0 || ysrc >= r->src_height)
+	put_pixel (out + xp*bpp, p->bg, bpp, p->weight, blend);
+      else
+	put_pixel (out + xp*bpp, p->src + xsrc / p->sub * bpp +
+		   ysrc / p->sub * p->src_stride, bpp, p->weight, blend);
+    }
+  }
+}
+
+KB_TEMPLATE
+nn_kernel (const GstKenburnsRenderer *r, const GstKenburnsMapping *m,
+	   const guint8 *src, guint8 *dst, gint y0, gint y1, gint weight,
+	   const int bpp, const gboolean rotate, const gboolean border,
+	   const gboolean blend) {
+  GstKenburnsPlane planes[3];
+  int i, nplanes;
+
+  nplanes = setup_planes (r, src, dst, y0, y1, weight, planes);
+  for(i=0; i < nplanes; i++) {
+    if (rotate)
+      nn_rotate_plane (r, m, &planes[i], bpp, border, blend);
+    else
+      nn_translate_plane (r, m, &planes[i], bpp, border, blend);
+  }
+}
+
+/*
+ * Bicubic and lanczos3
+ */
+
+/* intermediate fractional bits kept between the two filter passes */
+#define INTER_BITS 6
+
+/* Splits the plane coordinate c (pixel i covers [i, i+1)) into the first
+ * source tap and the weight table phase. */
+#define FILTER_TAP(f, c, first, phase) \
+  { \
+      FRAC u = (c) - 0.5; \
+      first = FLOOR_FRAC(u); \
+      phase = (int) ((u - first) * GST_KENBURNS_FILTER_PHASES + 0.5); \
+      if (phase == GST_KENBURNS_FILTER_PHASES) { phase = 0; first++; } \
+      first -= (f)->taps / 2 - 1; \
+  }
+
+/* The plane rows (or columns) [*c0, *c1) that are not border. */
+#define PLANE_BORDER_RANGE(r, p, size, lsize, c0, c1) \
+  { \
+      int l0, l1; \
+      BORDER_RANGE ((r)->border, lsize, l0, l1); \
+      c0 = MIN ((l0 + (p)->sub - 1) / (p)->sub, size); \
+      c1 = MAX (MIN ((l1 + (p)->sub - 1) / (p)->sub, size), c0); \
+  }
+
+static inline guint8
+filter_clamp (gint v, gint bits) {
+  v = (v + (1 << (bits - 1))) >> bits;
+  return CLAMP (v, 0, 255);
+}
+
+/* Without rotation the mapping is separable, so each plane is resampled
+ * horizontally into a small ring of intermediate rows and then vertically.
+ * A source row is filtered at most once per frame, and the tap offsets and
+ * weights of every output column and row are looked up once per frame.
+ * The tables and the ring are work buffers of the renderer. */
+KB_TEMPLATE
+filter_separable_pass (const GstKenburnsRenderer *r,
+		       const GstKenburnsMapping *m,
+		       const GstKenburnsPlane *p, const GstKenburnsFilter *f,
+		       const int ch, const int taps, int x0, int x1,
+		       int y0, int y1, const gboolean blend) {
+  FRAC xsrc0, ysrc0;
+  int xp, yp, j, k, c, first, phase, width = p->dst_width;
+  int ring_row[GST_KENBURNS_FILTER_MAX_TAPS];
+  int *xoff, *yfirst;
+  const gint16 **xw, **yw, *w;
+  gint16 *ring, *in;
+  const guint8 *row;
+  guint8 *out, pix[4];
+  gint acc;
+
+  xoff   = scratch_get (r, SCRATCH_FILTER_XOFF, width * taps * sizeof (int));
+  xw     = scratch_get (r, SCRATCH_FILTER_XW, width * sizeof (gint16 *));
+  yfirst = scratch_get (r, SCRATCH_FILTER_YFIRST, p->dst_height * sizeof (int));
+  yw     = scratch_get (r, SCRATCH_FILTER_YW, p->dst_height * sizeof (gint16 *));
+  ring   = scratch_get (r, SCRATCH_FILTER_RING,
+      taps * width * ch * sizeof (gint16));
+  memset (xw, 0, width * sizeof (gint16 *));
+  memset (yw, 0, p->dst_height * sizeof (gint16 *));
+
+  for(xp=x0; xp < x1; xp++) {
+    TRANSLATE (m, xsrc0, ysrc0, (xp + 0.5) * p->sub - 0.5, 0);
+    xsrc0 /= p->sub;
+    if (xsrc0 < 0 || xsrc0 >= p->src_width)
+      continue;
+    FILTER_TAP (f, xsrc0, first, phase);
+    xw[xp] = GST_KENBURNS_FILTER_WEIGHTS (f, phase);
+    for(j=0; j < taps; j++)
+      xoff[xp*taps + j] = CLAMP (first + j, 0, p->src_width - 1) * ch;
+  }
+  for(yp=y0; yp < y1; yp++) {
+    TRANSLATE (m, xsrc0, ysrc0, 0, (yp + 0.5) * p->sub - 0.5);
+    ysrc0 /= p->sub;
+    if (ysrc0 < 0 || ysrc0 >= p->src_height)
+      continue;
+    FILTER_TAP (f, ysrc0, first, phase);
+    yw[yp] = GST_KENBURNS_FILTER_WEIGHTS (f, phase);
+    yfirst[yp] = first;
+  }
+
+  /* the rows needed by one output row are taps consecutive source rows, so
+   * slot sy % taps never collides */
+  for(j=0; j < taps; j++)
+    ring_row[j] = -1;
+
+  for(yp=p->row0; yp < p->row1; yp++) {
+    out = p->dst + yp * p->dst_stride;
+    if (yw[yp] == NULL) {
+      put_span (out, 0, width, p, ch, blend);
+      continue;
+    }
+
+    /* horizontal pass for any source rows not in the ring yet */
+    for(j=0; j < taps; j++) {
+      int sy = CLAMP (yfirst[yp] + j, 0, p->src_height - 1);
+      if (ring_row[sy % taps] == sy)
+	continue;
+      ring_row[sy % taps] = sy;
+      row = p->src + sy * p->src_stride;
+      in  = ring + (sy % taps) * width * ch;
+      for(xp=x0; xp < x1; xp++) {
+	const int *off = xoff + xp*taps;
+	if ((w = xw[xp]) == NULL)
+	  continue;
+	for(c=0; c < ch; c++) {
+	  acc = 0;
+	  for(k=0; k < taps; k++)
+	    acc += w[k] * row[off[k] + c];
+	  in[xp*ch + c] = (acc + (1 << (GST_KENBURNS_FILTER_BITS - INTER_BITS - 1)))
+	      >> (GST_KENBURNS_FILTER_BITS - INTER_BITS);
+	}
+      }
+    }
+
+    /* vertical pass */
+    w = yw[yp];
+    for(xp=0; xp < width; xp++) {
+      if (xw[xp] == NULL) {
+	put_pixel (out + xp*ch, p->bg, ch, p->weight, blend);
+	continue;
+      }
+      for(c=0; c < ch; c++) {
+	acc = 0;
+	for(j=0; j < taps; j++) {
+	  int sy = CLAMP (yfirst[yp] + j, 0, p->src_height - 1);
+	  acc += w[j] * ring[(sy % taps) * width * ch + xp*ch + c];
+	}
+	pix[c] = filter_clamp (acc, GST_KENBURNS_FILTER_BITS + INTER_BITS);
+      }
+      put_pixel (out + xp*ch, pix, ch, p->weight, blend);
+    }
+  }
+}
+
+/* The tap count is a compile time constant for the unwidened kernel of
+ * the method, which covers all zoomed in frames, and a runtime value for
+ * the kernels widened when zoomed out. */
+KB_TEMPLATE
+filter_separable_plane (const GstKenburnsRenderer *r,
+			const GstKenburnsMapping *m,
+			const GstKenburnsPlane *p, const GstKenburnsFilter *f,
+			const int ch, const int taps,
+			const gboolean border, const gboolean blend) {
+  int x0 = 0, x1 = p->dst_width, y0 = 0, y1 = p->dst_height;
+
+  if (border) {
+    PLANE_BORDER_RANGE (r, p, p->dst_width, r->dst_width, x0, x1);
+    PLANE_BORDER_RANGE (r, p, p->dst_height, r->dst_height, y0, y1);
+  }
+  y0 = MAX (y0, p->row0);
+  y1 = MAX (MIN (y1, p->row1), y0);
+
+  if (f->taps == taps)
+    filter_separable_pass (r, m, p, f, ch, taps, x0, x1, y0, y1, blend);
+  else
+    filter_separable_pass (r, m, p, f, ch, f->taps, x0, x1, y0, y1, blend);
+}
+
+/* With rotation every output pixel needs its own taps x taps footprint. */
+KB_TEMPLATE
+filter_2d_plane (const GstKenburnsRenderer *r, const GstKenburnsMapping *m,
+		 const GstKenburnsPlane *p, const GstKenburnsFilter *f,
+		 const int ch, const int taps,
+		 const gboolean border, const gboolean blend) {
+  FRAC xsrc0, ysrc0;
+  int xp, yp, jx, jy, c, sx, sy, px, py;
+  int x0 = 0, x1 = p->dst_width, y0 = 0, y1 = p->dst_height;
+  int xoff[6], yoff[6];
+  const gint16 *wx, *wy;
+  const guint8 *row;
+  guint8 *out, pix[4];
+  gint acc, h;
+
+  if (border) {
+    PLANE_BORDER_RANGE (r, p, p->dst_width, r->dst_width, x0, x1);
+    PLANE_BORDER_RANGE (r, p, p->dst_height, r->dst_height, y0, y1);
+  }
+
+  for(yp=p->row0; yp < p->row1; yp++) {
+    out = p->dst + yp * p->dst_stride;
+    if (border && (yp < y0 || yp >= y1)) {
+      put_span (out, 0, p->dst_width, p, ch, blend);
+      continue;
+    }
+    if (border) {
+      put_span (out, 0, x0, p, ch, blend);
+      put_span (out, x1, p->dst_width, p, ch, blend);
+    }
+    for(xp=x0; xp < x1; xp++) {
+      TRANSFORM (m, xsrc0, ysrc0, (xp + 0.5) * p->sub - 0.5,
+		 (yp + 0.5) * p->sub - 0.5);
+      xsrc0 /= p->sub;
+      ysrc0 /= p->sub;
+      if (xsrc0 < 0 || xsrc0 >= p->src_width ||
+	  ysrc0 < 0 || ysrc0 >= p->src_height) {
+	put_pixel (out + xp*ch, p->bg, ch, p->weight, blend);
+	continue;
+      }
+      FILTER_TAP (f, xsrc0, sx, px);
+      FILTER_TAP (f, ysrc0, sy, py);
+      wx = GST_KENBURNS_FILTER_WEIGHTS (f, px);
+      wy = GST_KENBURNS_FILTER_WEIGHTS (f, py);
+      for(jx=0; jx < taps; jx++) {
+	xoff[jx] = CLAMP (sx + jx, 0, p->src_width  - 1) * ch;
+	yoff[jx] = CLAMP (sy + jx, 0, p->src_height - 1) * p->src_stride;
+      }
+      for(c=0; c < ch; c++) {
+	acc = 0;
+	for(jy=0; jy < taps; jy++) {
+	  row = p->src + yoff[jy] + c;
+	  h = 0;
+	  for(jx=0; jx < taps; jx++)
+	    h += wx[jx] * row[xoff[jx]];
+	  acc += wy[jy] * ((h + (1 << (GST_KENBURNS_FILTER_BITS - INTER_BITS - 1)))
+			   >> (GST_KENBURNS_FILTER_BITS - INTER_BITS));
+	}
+	pix[c] = filter_clamp (acc, GST_KENBURNS_FILTER_BITS + INTER_BITS);
+      }
+      put_pixel (out + xp*ch, pix, ch, p->weight, blend);
+    }
+  }
+}
+
+KB_TEMPLATE
+filter_kernel (const GstKenburnsRenderer *r, const GstKenburnsMapping *m,
+	       const GstKenburnsFilter *filter, const guint8 *src, guint8 *dst,
+	       gint y0, gint y1, gint weight, const int bpp, const int taps,
+	       const gboolean rotate, const gboolean border,
+	       const gboolean blend) {
+  GstKenburnsPlane planes[3];
+  int i, nplanes;
+
+  if (rotate)
+    g_assert (filter->taps == taps);
+
+  nplanes = setup_planes (r, src, dst, y0, y1, weight, planes);
+  for(i=0; i < nplanes; i++) {
+    if (rotate)
+      filter_2d_plane (r, m, &planes[i], filter, bpp, taps, border, blend);
+    else
+      filter_separable_plane (r, m, &planes[i], filter, bpp, taps, border,
+          blend);
+  }
+}
+
+/* Builds the weight table of mapping m. The chroma planes are scaled like
+ * the luma plane, so one table does for all of them. */
+static void
+filter_setup (const GstKenburnsRenderer *r, const GstKenburnsMapping *m,
+	      GstKenburnsFilter *filter) {
+  if (m->rotate)
+    gst_kenburns_filter_build (filter, r->interp_method, 1.0);
+  else
+    gst_kenburns_filter_build (filter, r->interp_method,
+        FRAC_MULT (m->zoomx, m->zposx));
+}
+
+/* The weight tables of the n mappings of a frame, built once so that all
+ * bands of the frame can share them, or NULL for nearest neighbor. */
+static const GstKenburnsFilter *
+filters_setup (const GstKenburnsRenderer *r, const GstKenburnsMapping *maps,
+	       gint n) {
+  GstKenburnsFilter *filters;
+  int i;
+
+  if (r->interp_method == GST_KENBURNS_INTERP_METHOD_NEAREST)
+    return NULL;
+  filters = scratch_get (r, SCRATCH_FILTERS, n * sizeof (GstKenburnsFilter));
+  for(i=0; i < n; i++)
+    filter_setup (r, &maps[i], &filters[i]);
+  return filters;
+}
+
+/*
+ * Nearest neighbor motion blur
+ *
+ * For each destination pixel of a row, the nearest neighbor source
+ * coordinates of all n sub-frame samples are computed up front into sx/sy
+ * (pixel major, -1 when the sample is out of bounds) so that the gather
+ * loops below only need to accumulate. Without rotation the source column
+ * of a sample only depends on xdst and the source row only on ydst, so sx
+ * is filled once per frame and sy holds the n source rows of the current
+ * row (sy_step is 0). With rotation both are filled per row, stepping the
+ * projective mapping of each sample along the row (see blur_row_map).
+ */
+
+#define MAX_BLUR_SAMPLES 64
+
+/* The mapping of one sample along a destination row: the source
+ * coordinates are (x/w + xc, y/w + yc) scaled by zposx/zposy, where x, y
+ * and w advance by dx, dy and dw per destination column. */
+typedef struct {
+  FRAC x, y, w, dx, dy, dw, xc, yc;
+} GstKenburnsRowMap;
+
+typedef struct {
+  gint n;
+  gboolean rotate;
+  gint *sx, *sy;
+  gint sy_step;
+} GstKenburnsBlur;
+
+/* Numerators and denominator of TRANSFORM at (xdst, ydst), without the
+ * constant offsets */
+static inline void
+blur_project (const GstKenburnsMapping *m, FRAC xdst, FRAC ydst,
+	      FRAC *x, FRAC *y, FRAC *w) {
+  FRAC x0, y0, x1, y1;
+
+  x0 = FRAC_MULT ((xdst + m->xd0), m->zoomx);
+  y0 = FRAC_MULT ((ydst + m->yd0), m->zoomy);
+  x1 = FRAC_MULT(x0, m->cos_thetaz) - FRAC_MULT(y0, m->sin_thetaz);
+  y1 = FRAC_MULT(x0, m->sin_thetaz) + FRAC_MULT(y0, m->cos_thetaz);
+  *w = FRAC_MULT(-x1, m->tan_thetax_on_cos_thetay) + FRAC_MULT(y1, m->tan_thetay) + m->z1;
+  *x = FRAC_MULT(m->z1, (FRAC_MULT(x1, m->cos_thetax)
+      + FRAC_MULT(FRAC_MULT(y1, m->sin_thetay), m->sin_thetax)
+      + FRAC_MULT(FRAC_MULT(m->z1, m->cos_thetay), m->sin_thetax)));
+  *y = FRAC_MULT(m->z1, (FRAC_MULT(y1, m->cos_thetay) - FRAC_MULT(m->z1, m->sin_thetay)));
+}
+
+/* Everything in TRANSFORM before the division is affine in xdst */
+static void
+blur_row_map (const GstKenburnsMapping *m, int ydst, GstKenburnsRowMap *row) {
+  FRAC x, y, w;
+
+  blur_project (m, 0, INT2FRAC (ydst), &row->x, &row->y, &row->w);
+  blur_project (m, INT2FRAC (1), INT2FRAC (ydst), &x, &y, &w);
+  row->dx = x - row->x;
+  row->dy = y - row->y;
+  row->dw = w - row->w;
+  row->xc = m->xs3 - FRAC_MULT(FRAC_MULT(m->z1, m->cos_thetay), m->sin_thetax);
+  row->yc = m->ys3 + FRAC_MULT(m->z1, m->sin_thetay);
+}
+
+static void
+blur_init (const GstKenburnsRenderer *r, GstKenburnsBlur *blur,
+	   const GstKenburnsMapping *maps, gint n) {
+  FRAC xsrc0, ysrc0;
+  int xdst, xsrc, k;
+
+  blur->n = n;
+  blur->rotate = FALSE;
+  for(k=0; k < n; k++)
+    blur->rotate |= maps[k].rotate;
+
+  blur->sy_step = blur->rotate ? n : 0;
+  blur->sx = scratch_get (r, SCRATCH_BLUR_SX, n * r->dst_width * sizeof (gint));
+  blur->sy = scratch_get (r, SCRATCH_BLUR_SY,
+      (blur->rotate ? n * r->dst_width : n) * sizeof (gint));
+
+  if (!blur->rotate) {
+    for(xdst=0; xdst < r->dst_width; xdst++) {
+      for(k=0; k < n; k++) {
+	TRANSLATE (&maps[k], xsrc0, ysrc0, xdst, 0);
+	xsrc = FLOOR_FRAC(xsrc0);
+	blur->sx[xdst*n + k] = (xsrc < 0 || xsrc >= r->src_width) ? -1 : xsrc;
+      }
+    }
+  }
+  (void) ysrc0;
+}
+
+static void
+blur_row (const GstKenburnsRenderer *r, GstKenburnsBlur *blur,
+	  const GstKenburnsMapping *maps, int ydst) {
+  FRAC xsrc0, ysrc0;
+  int xdst, xsrc, ysrc, k, n = blur->n;
+
+  if (blur->rotate) {
+    for(k=0; k < n; k++) {
+      const GstKenburnsMapping *m = &maps[k];
+      GstKenburnsRowMap row;
+      FRAC x, y, w, det;
+
+      blur_row_map (m, ydst, &row);
+      x = row.x;
+      y = row.y;
+      w = row.w;
+      for(xdst=0; xdst < r->dst_width; xdst++, x += row.dx, y += row.dy, w += row.dw) {
+	det = (w == 0) ? INC_FROM_ZERO : w;
+	xsrc = FLOOR_FRAC(FRAC_MULT((FRAC_DIV(x, det) + row.xc), m->zposx));
+	ysrc = FLOOR_FRAC(FRAC_MULT((FRAC_DIV(y, det) + row.yc), m->zposy));
+	if (xsrc < 0 || xsrc >= r->src_width ||
+	    ysrc < 0 || ysrc >= r->src_height) {
+	  blur->sx[xdst*n + k] = blur->sy[xdst*n + k] = -1;
+	} else {
+	  blur->sx[xdst*n + k] = xsrc;
+	  blur->sy[xdst*n + k] = ysrc;
+	}
+      }
+    }
+  } else {
+    for(k=0; k < n; k++) {
+      TRANSLATE (&maps[k], xsrc0, ysrc0, 0, ydst);
+      ysrc = FLOOR_FRAC(ysrc0);
+      blur->sy[k] = (ysrc < 0 || ysrc >= r->src_height) ? -1 : ysrc;
+    }
+  }
+  (void) xsrc0;
+}
+
+/* Averages the accumulated samples, (1<<16)/n is exact enough for n<=64 */
+#define BLUR_NORM(acc, norm) (((acc) * (norm) + (1 << 15)) >> 16)
+
+KB_TEMPLATE
+blur_packed (const GstKenburnsRenderer *r, const GstKenburnsMapping *maps,
+	     gint n, const guint8 *src, guint8 *dst, const int num_bytes) {
+  GstKenburnsBlur blur;
+  const guint8 *pix, *bgcolor = r->bg;
+  guint8 *out;
+  int xdst, ydst, k, c;
+  int dst_stride, src_stride, x0, x1, y0, y1;
+  guint acc[4], norm = (1 << 16) / n;
+  const gint *sx, *sy;
+
+  dst_stride = gst_video_format_get_row_stride(r->dst_fmt, 0, r->dst_width);
+  src_stride = gst_video_format_get_row_stride(r->src_fmt, 0, r->src_width);
+  BORDER_RANGE (r->border, r->dst_width, x0, x1);
+  BORDER_RANGE (r->border, r->dst_height, y0, y1);
+
+  blur_init (r, &blur, maps, n);
+  for(ydst=0; ydst < r->dst_height; ydst++) {
+    out = dst + ydst * dst_stride;
+    if (ydst < y0 || ydst >= y1) {
+      fill_span (out, 0, r->dst_width, bgcolor, num_bytes);
+      continue;
+    }
+    fill_span (out, 0, x0, bgcolor, num_bytes);
+    fill_span (out, x1, r->dst_width, bgcolor, num_bytes);
+    blur_row (r, &blur, maps, ydst);
+    for(xdst=x0; xdst < x1; xdst++) {
+      sx = blur.sx + xdst*n;
+      sy = blur.sy + xdst*blur.sy_step;
+      acc[0] = acc[1] = acc[2] = acc[3] = 0;
+      for(k=0; k < n; k++) {
+	if (sx[k] < 0 || sy[k] < 0)
+	  pix = bgcolor;
+	else
+	  pix = src + sx[k]*num_bytes + sy[k]*src_stride;
+	for(c=0; c < num_bytes; c++)
+	  acc[c] += pix[c];
+      }
+      for(c=0; c < num_bytes; c++)
+	out[xdst*num_bytes + c] = BLUR_NORM (acc[c], norm);
+    }
+  }
+}
+
+static void
+blur_i420 (const GstKenburnsRenderer *r, const GstKenburnsMapping *maps,
+	   gint n, const guint8 *src, guint8 *dst) {
+  GstKenburnsBlur blur;
+  const guint8 *bgcolor = r->bg;
+  int xdst, ydst, k;
+  int dst_strideY, dst_strideUV, src_strideY, src_strideUV;
+  int dst_offsetU, dst_offsetV,  src_offsetU, src_offsetV;
+  int posUVsrc, posUVdst, x0, x1, y0, y1;
+  guint Y, U, V, norm = (1 << 16) / n;
+  gboolean chroma;
+  const gint *sx, *sy;
+
+  dst_strideY  = gst_video_format_get_row_stride(r->dst_fmt, 0, r->dst_width);
+  dst_strideUV = gst_video_format_get_row_stride(r->dst_fmt, 1, r->dst_width);
+  src_strideY  = gst_video_format_get_row_stride(r->src_fmt, 0, r->src_width);
+  src_strideUV = gst_video_format_get_row_stride(r->src_fmt, 1, r->src_width);
+
+  dst_offsetU = gst_video_format_get_component_offset(r->dst_fmt, 1, r->dst_width, r->dst_height);
+  dst_offsetV = gst_video_format_get_component_offset(r->dst_fmt, 2, r->dst_width, r->dst_height);
+  src_offsetU = gst_video_format_get_component_offset(r->src_fmt, 1, r->src_width, r->src_height);
+  src_offsetV = gst_video_format_get_component_offset(r->src_fmt, 2, r->src_width, r->src_height);
+
+  BORDER_RANGE (r->border, r->dst_width, x0, x1);
+  BORDER_RANGE (r->border, r->dst_height, y0, y1);
+
+  blur_init (r, &blur, maps, n);
+  for(ydst=0; ydst < r->dst_height; ydst++) {
+    gboolean border_row = (ydst < y0 || ydst >= y1);
+
+    if (!border_row)
+      blur_row (r, &blur, maps, ydst);
+    for(xdst=0; xdst < r->dst_width; xdst++) {
+      /* chroma is only gathered once per 2x2 block */
+      chroma = !(xdst & 1) && !(ydst & 1);
+      posUVdst = xdst/2 + ydst/2 * dst_strideUV;
+
+      if (border_row || xdst < x0 || xdst >= x1) {
+	dst[xdst + ydst * dst_strideY] = bgcolor[0];
+	if (chroma) {
+	  dst[posUVdst + dst_offsetU] = bgcolor[1];
+	  dst[posUVdst + dst_offsetV] = bgcolor[2];
+	}
+	continue;
+      }
+
+      sx = blur.sx + xdst*n;
+      sy = blur.sy + xdst*blur.sy_step;
+      Y = U = V = 0;
+      for(k=0; k < n; k++) {
+	if (sx[k] < 0 || sy[k] < 0) {
+	  Y += bgcolor[0];
+	  U += bgcolor[1];
+	  V += bgcolor[2];
+	} else {
+	  Y += src[sx[k] + sy[k] * src_strideY];
+	  if (chroma) {
+	    posUVsrc = sx[k]/2 + sy[k]/2 * src_strideUV;
+	    U += src[posUVsrc + src_offsetU];
+	    V += src[posUVsrc + src_offsetV];
+	  }
+	}
+      }
+      dst[xdst + ydst * dst_strideY] = BLUR_NORM (Y, norm);
+      if (chroma) {
+	dst[posUVdst + dst_offsetU] = BLUR_NORM (U, norm);
+	dst[posUVdst + dst_offsetV] = BLUR_NORM (V, norm);
+      }
+    }
+  }
+}
+
+/*
+ * Kernel table
+ */
+
+enum {
+  LAYOUT_PACKED3,
+  LAYOUT_PACKED4,
+  LAYOUT_I420,
+  N_LAYOUTS
+};
+
+#define KERNEL_ARGS \
+  const GstKenburnsRenderer *r, const GstKenburnsMapping *m, \
+  const GstKenburnsFilter *filter, const guint8 *src, guint8 *dst, \
+  gint y0, gint y1, gint weight
+
+/* wrapper names end in the rotation, border and blend settings */
+#define DEFINE_NN_1(name, bpp, rot, bord, blend) \
+  static void name##_##rot##bord##blend (KERNEL_ARGS) { \
+    nn_kernel (r, m, src, dst, y0, y1, weight, bpp, rot, bord, blend); \
+    (void) filter; \
+  }
+#define DEFINE_FILTER_1(name, bpp, taps, rot, bord, blend) \
+  static void name##_##rot##bord##blend (KERNEL_ARGS) { \
+    filter_kernel (r, m, filter, src, dst, y0, y1, weight, bpp, taps, rot, \
+        bord, blend); \
+  }
+
+#define DEFINE_NN(name, bpp) \
+  DEFINE_NN_1 (name, bpp, 0, 0, 0) DEFINE_NN_1 (name, bpp, 0, 0, 1) \
+  DEFINE_NN_1 (name, bpp, 0, 1, 0) DEFINE_NN_1 (name, bpp, 0, 1, 1) \
+  DEFINE_NN_1 (name, bpp, 1, 0, 0) DEFINE_NN_1 (name, bpp, 1, 0, 1) \
+  DEFINE_NN_1 (name, bpp, 1, 1, 0) DEFINE_NN_1 (name, bpp, 1, 1, 1)
+
+#define DEFINE_FILTER(name, bpp, taps) \
+  DEFINE_FILTER_1 (name, bpp, taps, 0, 0, 0) DEFINE_FILTER_1 (name, bpp, taps, 0, 0, 1) \
+  DEFINE_FILTER_1 (name, bpp, taps, 0, 1, 0) DEFINE_FILTER_1 (name, bpp, taps, 0, 1, 1) \
+  DEFINE_FILTER_1 (name, bpp, taps, 1, 0, 0) DEFINE_FILTER_1 (name, bpp, taps, 1, 0, 1) \
+  DEFINE_FILTER_1 (name, bpp, taps, 1, 1, 0) DEFINE_FILTER_1 (name, bpp, taps, 1, 1, 1)
+
+#define KERNELS(name) \
+  { { { name##_000, name##_001 }, { name##_010, name##_011 } }, \
+    { { name##_100, name##_101 }, { name##_110, name##_111 } } }
+
+DEFINE_NN (nn_packed3, 3)
+DEFINE_NN (nn_packed4, 4)
+DEFINE_NN (nn_i420, 1)
+DEFINE_FILTER (bicubic_packed3, 3, 4)
+DEFINE_FILTER (bicubic_packed4, 4, 4)
+DEFINE_FILTER (bicubic_i420, 1, 4)
+DEFINE_FILTER (lanczos3_packed3, 3, 6)
+DEFINE_FILTER (lanczos3_packed4, 4, 6)
+DEFINE_FILTER (lanczos3_i420, 1, 6)
+
+/* indexed by layout, interpolation method, rotation, border and blend */
+static const GstKenburnsKernel kernels[N_LAYOUTS][GST_KENBURNS_N_INTERP_METHODS][2][2][2] = {
+  { KERNELS (nn_packed3), KERNELS (bicubic_packed3), KERNELS (lanczos3_packed3) },
+  { KERNELS (nn_packed4), KERNELS (bicubic_packed4), KERNELS (lanczos3_packed4) },
+  { KERNELS (nn_i420),    KERNELS (bicubic_i420),    KERNELS (lanczos3_i420) },
+};
+
+static void
+blur_packed3 (const GstKenburnsRenderer *r, const GstKenburnsMapping *maps,
+	      gint n, const guint8 *src, guint8 *dst) {
+  blur_packed (r, maps, n, src, dst, 3);
+}
+
+static void
+blur_packed4 (const GstKenburnsRenderer *r, const GstKenburnsMapping *maps,
+	      gint n, const guint8 *src, guint8 *dst) {
+  blur_packed (r, maps, n, src, dst, 4);
+}
+
+static const GstKenburnsBlurKernel blur_kernels[N_LAYOUTS] = {
+  blur_packed3, blur_packed4, blur_i420
+};
+
+/* bytes of destination rows rendered from both images of a crossfade, or
+ * rendered and converted, before moving on; about what stays in a second
+ * level cache */
+#define BAND_SIZE (256 * 1024)
+
+/*
+ * Format conversion
+ *
+ * When the destination format differs from the source format, the kernels
+ * still render in the source format, a band of rows at a time into a small
+ * scratch image, and each band is converted to the destination while it
+ * is still in the cache.
+ */
+
+/* What the conversion needs to know about a format at compile time: the
+ * formats of a class differ only in the order of their components. */
+enum {
+  CONV_RGB,			/* 24 bit RGB and BGR */
+  CONV_RGBX,			/* 32 bit RGB with padding */
+  CONV_RGBA,			/* 32 bit RGB with alpha */
+  CONV_AYUV,
+  CONV_I420,
+  N_CONVS
+};
+
+#define CONV_YUV(k)   ((k) == CONV_AYUV || (k) == CONV_I420)
+#define CONV_ALPHA(k) ((k) == CONV_RGBA || (k) == CONV_AYUV)
+#define CONV_COMPS(k) (((k) == CONV_RGB || (k) == CONV_I420) ? 3 : 4)
+#define CONV_STEP(k)  (((k) == CONV_I420) ? 1 : CONV_COMPS (k))
+#define CONV_SUB(k)   ((k) == CONV_I420)
+
+static gint
+conv_class (GstVideoFormat fmt) {
+  if (fmt == GST_VIDEO_FORMAT_I420)
+    return CONV_I420;
+  if (gst_video_format_get_pixel_stride (fmt, 0) == 3)
+    return CONV_RGB;
+  if (gst_video_format_is_yuv (fmt))
+    return CONV_AYUV;
+  return gst_video_format_has_alpha (fmt) ? CONV_RGBA : CONV_RGBX;
+}
+
+/* Where the components of an image are: component c of a row of a format
+ * of class k starts at data[c] + (y >> CONV_SUB (k)) * stride[c] for
+ * chroma, and at data[c] + y * stride[c] otherwise. Components 0 to 2 are
+ * R, G and B or Y, U and V, and component 3 of the 32 bit formats is
+ * alpha or padding. */
+typedef struct {
+  guint8 *data[4];
+  gint stride[4];
+} GstKenburnsLayout;
+
+static void
+layout_init (GstKenburnsLayout *l, GstVideoFormat fmt, gint width,
+	     gint height, guint8 *data, gint ncomps) {
+  int c;
+
+  for(c=0; c < ncomps; c++) {
+    l->data[c]   = data + gst_video_format_get_component_offset (fmt, c, width, height);
+    l->stride[c] = gst_video_format_get_row_stride (fmt, c, width);
+  }
+}
+
+/* component c of pixel x of the row p of a format of class k */
+#define CONV_AT(p, c, x, k) \
+  ((p)[c] + ((CONV_SUB (k) && (c) > 0) ? (x) >> 1 : (x) * CONV_STEP (k)))
+
+/* Points p at row y of the components of l */
+KB_TEMPLATE
+conv_rows (const GstKenburnsLayout *l, int y, guint8 *p[4], const int k) {
+  int c;
+
+  for(c=0; c < CONV_COMPS (k); c++)
+    p[c] = l->data[c] + ((CONV_SUB (k) && c > 0) ? y >> 1 : y) * l->stride[c];
+}
+
+KB_TEMPLATE
+conv_read (guint8 *const p[4], int x, int s[4], const int k) {
+  int c;
+
+  for(c=0; c < CONV_COMPS (k); c++)
+    s[c] = *CONV_AT (p, c, x, k);
+}
+
+/* writes the full resolution components d of pixel x */
+KB_TEMPLATE
+conv_write (guint8 *const p[4], int x, const int d[4], const int k) {
+  int c;
+
+  for(c=0; c < (CONV_SUB (k) ? 1 : CONV_COMPS (k)); c++)
+    *CONV_AT (p, c, x, k) = d[c];
+}
+
+/* Converts the components s of a pixel of class ik into those of ok */
+KB_TEMPLATE
+conv_pixel (const int s[4], int d[4], const int ik, const int ok) {
+  if (CONV_YUV (ik) && !CONV_YUV (ok)) {
+    COMP_R (d[0], s[0], s[1], s[2]);
+    COMP_G (d[1], s[0], s[1], s[2]);
+    COMP_B (d[2], s[0], s[1], s[2]);
+  } else if (!CONV_YUV (ik) && CONV_YUV (ok)) {
+    COMP_Y (d[0], s[0], s[1], s[2]);
+    COMP_U (d[1], s[0], s[1], s[2]);
+    COMP_V (d[2], s[0], s[1], s[2]);
+  } else {
+    d[0] = s[0];
+    d[1] = s[1];
+    d[2] = s[2];
+  }
+  d[3] = CONV_ALPHA (ik) ? s[3] : 255;
+}
+
+/* Converts the rows rendered into band, in the source format of class ik,
+ * to the destination rows [y0, y0 + rows) of dst, of class ok, y0 being
+ * even, and puts the background components bg over the border. */
+KB_TEMPLATE
+convert_band (const GstKenburnsRenderer *r, const guint8 *band, guint8 *dst,
+	      gint y0, gint rows, const int bg[4], const int ik, const int ok) {
+  GstKenburnsLayout in, out;
+  guint8 *ip[4], *ip1[4], *op[4];
+  int x, y, c, xa, xb, x0, x1, b0, b1, cx, cy, cw, ch, n, pairs;
+  int s[4], d[4], sum[4];
+
+  layout_init (&in, r->src_fmt, r->dst_width, rows, (guint8 *) band,
+      CONV_COMPS (ik));
+  layout_init (&out, r->dst_fmt, r->dst_width, r->dst_height, dst,
+      CONV_COMPS (ok));
+  BORDER_RANGE (r->border, r->dst_width, x0, x1);
+  BORDER_RANGE (r->border, r->dst_height, b0, b1);
+
+  /* full resolution components */
+  for(y=y0; y < y0 + rows; y++) {
+    conv_rows (&in, y - y0, ip, ik);
+    conv_rows (&out, y, op, ok);
+    xa = (y < b0 || y >= b1) ? r->dst_width : x0;
+    xb = (y < b0 || y >= b1) ? r->dst_width : x1;
+    for(x=0; x < xa; x++)
+      conv_write (op, x, bg, ok);
+    for(; x < xb; x++) {
+      conv_read (ip, x, s, ik);
+      conv_pixel (s, d, ik, ok);
+      conv_write (op, x, d, ok);
+    }
+    for(; x < r->dst_width; x++)
+      conv_write (op, x, bg, ok);
+  }
+
+  /* subsampled chroma, from the average of the pixels of each block */
+  if (!CONV_SUB (ok))
+    return;
+  cw = (r->dst_width + 1) / 2;
+  ch = (r->dst_height + 1) / 2;
+  x0 = MIN ((x0 + 1) / 2, cw);
+  x1 = MAX (MIN ((x1 + 1) / 2, cw), x0);
+  b0 = MIN ((b0 + 1) / 2, ch);
+  b1 = MAX (MIN ((b1 + 1) / 2, ch), b0);
+  /* blocks with both columns in the image */
+  pairs = r->dst_width / 2;
+  for(cy=y0 / 2; cy < (y0 + rows + 1) / 2; cy++) {
+    conv_rows (&in, 2*cy - y0, ip, ik);
+    /* the last row of an odd height has no second row */
+    conv_rows (&in, MIN (2*cy + 1, y0 + rows - 1) - y0, ip1, ik);
+    n = (2*cy + 1 < y0 + rows) ? 2 : 1;
+    conv_rows (&out, 2*cy, op, ok);
+    xa = (cy < b0 || cy >= b1) ? cw : x0;
+    xb = (cy < b0 || cy >= b1) ? cw : x1;
+    for(cx=0; cx < cw; cx++) {
+      if (cx < xa || cx >= xb) {
+	memcpy (d, bg, sizeof (d));
+      } else {
+	conv_read (ip, 2*cx, s, ik);
+	memcpy (sum, s, sizeof (sum));
+	if (n == 2) {
+	  conv_read (ip1, 2*cx, s, ik);
+	  for(c=0; c < CONV_COMPS (ik); c++)
+	    sum[c] += s[c];
+	}
+	if (cx < pairs) {
+	  conv_read (ip, 2*cx + 1, s, ik);
+	  for(c=0; c < CONV_COMPS (ik); c++)
+	    sum[c] += s[c];
+	  if (n == 2) {
+	    conv_read (ip1, 2*cx + 1, s, ik);
+	    for(c=0; c < CONV_COMPS (ik); c++)
+	      sum[c] += s[c];
+	  }
+	  for(c=0; c < CONV_COMPS (ik); c++)
+	    s[c] = (sum[c] + n) / (2 * n);
+	} else {
+	  for(c=0; c < CONV_COMPS (ik); c++)
+	    s[c] = (sum[c] + n / 2) / n;
+	}
+	conv_pixel (s, d, ik, ok);
+      }
+      *CONV_AT (op, 1, 2*cx, ok) = d[1];
+      *CONV_AT (op, 2, 2*cx, ok) = d[2];
+    }
+  }
+}
+
+#define DEFINE_CONVERT_1(in, out) \
+  static void convert_##in##_##out (const GstKenburnsRenderer *r, \
+      const guint8 *band, guint8 *dst, gint y0, gint rows, \
+      const int bg[4]) { \
+    convert_band (r, band, dst, y0, rows, bg, CONV_##in, CONV_##out); \
+  }
+
+#define DEFINE_CONVERT(in) \
+  DEFINE_CONVERT_1 (in, RGB) DEFINE_CONVERT_1 (in, RGBX) \
+  DEFINE_CONVERT_1 (in, RGBA) DEFINE_CONVERT_1 (in, AYUV) \
+  DEFINE_CONVERT_1 (in, I420)
+
+#define CONVERTS(in) \
+  { convert_##in##_RGB, convert_##in##_RGBX, convert_##in##_RGBA, \
+    convert_##in##_AYUV, convert_##in##_I420 }
+
+DEFINE_CONVERT (RGB)
+DEFINE_CONVERT (RGBX)
+DEFINE_CONVERT (RGBA)
+DEFINE_CONVERT (AYUV)
+DEFINE_CONVERT (I420)
+
+/* indexed by the classes of the source and destination formats */
+static const GstKenburnsConvertKernel converts[N_CONVS][N_CONVS] = {
+  CONVERTS (RGB), CONVERTS (RGBX), CONVERTS (RGBA), CONVERTS (AYUV),
+  CONVERTS (I420)
+};
+
+/* rows of the bands a frame is rendered in by the paths below, even so
+ * that I420 chroma rows are not split */
+static gint
+band_rows (const GstKenburnsRenderer *r) {
+  gint rows;
+
+  rows = BAND_SIZE / gst_video_format_get_row_stride (r->src_fmt, 0, r->dst_width);
+  return MIN (MAX (rows, 16) & ~1, r->dst_height);
+}
+
+/* Motion blur with bicubic or lanczos3: each sample is rendered by the
+ * filter kernels, a band of rows at a time, and summed up while the band
+ * is still in the cache. */
+static void
+blur_filtered (const GstKenburnsRenderer *r, const GstKenburnsMapping *maps,
+	       gint n, const GstKenburnsFilter *filters, const guint8 *src,
+	       guint8 *dst) {
+  GstKenburnsPlane planes[3];
+  guint16 *acc, *a;
+  guint8 *out;
+  guint norm = (1 << 16) / n;
+  int rows, y, y1, i, k, c, x, width, nplanes;
+  gint64 t0;
+
+  rows = band_rows (r);
+  acc = scratch_get (r, SCRATCH_BLUR_ACC, gst_video_format_get_size (r->dst_fmt,
+          r->dst_width, rows) * sizeof (guint16));
+
+  for(y=0; y < r->dst_height; y += rows) {
+    t0 = GST_KENBURNS_TRACE_NOW ();
+    y1 = MIN (y + rows, r->dst_height);
+    nplanes = setup_planes (r, src, dst, y, y1, 0, planes);
+    for(k=0; k < n; k++) {
+      r->kernel[maps[k].rotate ? TRUE : FALSE][FALSE] (r, &maps[k],
+          &filters[k], src, dst, y, y1, 0);
+      for(i=0, a=acc; i < nplanes; i++) {
+	width = planes[i].dst_width * planes[i].channels;
+	for(c=planes[i].row0; c < planes[i].row1; c++, a += width) {
+	  out = planes[i].dst + c * planes[i].dst_stride;
+	  if (k == 0)
+	    for(x=0; x < width; x++)
+	      a[x] = out[x];
+	  else
+	    for(x=0; x < width; x++)
+	      a[x] += out[x];
+	}
+      }
+    }
+    for(i=0, a=acc; i < nplanes; i++) {
+      width = planes[i].dst_width * planes[i].channels;
+      for(c=planes[i].row0; c < planes[i].row1; c++, a += width) {
+	out = planes[i].dst + c * planes[i].dst_stride;
+	for(x=0; x < width; x++)
+	  out[x] = BLUR_NORM (a[x], norm);
+      }
+    }
+    GST_KENBURNS_TRACE_SPAN ("band", t0, "y", y);
+  }
+}
+
+/* Renders src into dst in the source format. */
+static void
+render_frame (const GstKenburnsRenderer *r, const GstKenburnsMapping *maps,
+	      gint n, const GstKenburnsFilter *filters, const guint8 *src,
+	      guint8 *dst) {
+  if (n > 1 && filters)
+    blur_filtered (r, maps, n, filters, src, dst);
+  else if (n > 1)
+    r->blur (r, maps, n, src, dst);
+  else
+    r->kernel[maps[0].rotate ? TRUE : FALSE][FALSE] (r, &maps[0], filters,
+        src, dst, 0, r->dst_height, 0);
+}
+
+/* The plain path renders a frame with a single kernel call. When tracing,
+ * it is rendered in bands like the other paths instead, so that the trace
+ * shows per band spans for it too; the output is the same. */
+static void
+render_traced (const GstKenburnsRenderer *r, const GstKenburnsMapping *m,
+	       const GstKenburnsFilter *filter, const guint8 *src,
+	       guint8 *dst) {
+  GstKenburnsKernel kernel = r->kernel[m->rotate ? TRUE : FALSE][FALSE];
+  gint64 t0;
+  int rows, y;
+
+  rows = band_rows (r);
+  for(y=0; y < r->dst_height; y += rows) {
+    t0 = GST_KENBURNS_TRACE_NOW ();
+    kernel (r, m, filter, src, dst, y, MIN (y + rows, r->dst_height), 0);
+    GST_KENBURNS_TRACE_SPAN ("band", t0, "y", y);
+  }
+}
+
+/* Renders each band as the top rows of a frame of the band's height, by
+ * moving the mappings up, so that the kernels can write it to the start
+ * of the scratch image. The border is left to the conversion. */
+static void
+render_converted (const GstKenburnsRenderer *r, const GstKenburnsMapping *maps,
+		  gint n, const GstKenburnsFilter *filters, const guint8 *src,
+		  guint8 *dst) {
+  GstKenburnsMapping band_maps[MAX_BLUR_SAMPLES];
+  GstKenburnsRenderer band = *r;
+  const guint32 *bgcolor = r->bgcolor;
+  guint8 *scratch;
+  gint64 t0, t1;
+  int bg[4], rows, y, i;
+
+  band.dst_fmt = r->src_fmt;
+  band.border = 0;
+  gst_kenburns_renderer_configure (&band);
+
+  rows = band_rows (r);
+  scratch = scratch_get (r, SCRATCH_CONVERT,
+      gst_video_format_get_size (r->src_fmt, r->dst_width, rows));
+
+  if (gst_video_format_is_yuv (r->dst_fmt)) {
+    COMP_Y (bg[0], bgcolor[BG_RED], bgcolor[BG_GREEN], bgcolor[BG_BLUE]);
+    COMP_U (bg[1], bgcolor[BG_RED], bgcolor[BG_GREEN], bgcolor[BG_BLUE]);
+    COMP_V (bg[2], bgcolor[BG_RED], bgcolor[BG_GREEN], bgcolor[BG_BLUE]);
+  } else {
+    bg[0] = bgcolor[BG_RED];
+    bg[1] = bgcolor[BG_GREEN];
+    bg[2] = bgcolor[BG_BLUE];
+  }
+  bg[3] = bgcolor[BG_ALPHA];
+
+  for(y=0; y < r->dst_height; y += rows) {
+    t0 = GST_KENBURNS_TRACE_NOW ();
+    band.dst_height = MIN (rows, r->dst_height - y);
+    for(i=0; i < n; i++) {
+      band_maps[i] = maps[i];
+      band_maps[i].yd0 += y;
+    }
+    render_frame (&band, band_maps, n, filters, src, scratch);
+    t1 = GST_KENBURNS_TRACE_NOW ();
+    r->convert (r, scratch, dst, y, band.dst_height, bg);
+    GST_KENBURNS_TRACE_SPAN ("convert", t1, "y", y);
+    GST_KENBURNS_TRACE_SPAN ("band", t0, "y", y);
+  }
+}
+
+/* Converts the ARGB background color to the destination format */
+static void
+configure_bg (GstKenburnsRenderer * r)
+{
+  const guint32 *bg = r->bgcolor;
+  guint8 *out = r->bg;
+
+  memset (out, 0, sizeof (r->bg));
+  switch (r->dst_fmt) {
+  case GST_VIDEO_FORMAT_I420:
+    COMP_Y (out[0], bg[BG_RED], bg[BG_GREEN], bg[BG_BLUE]);
+    COMP_U (out[1], bg[BG_RED], bg[BG_GREEN], bg[BG_BLUE]);
+    COMP_V (out[2], bg[BG_RED], bg[BG_GREEN], bg[BG_BLUE]);
+    break;
+  case GST_VIDEO_FORMAT_AYUV:
+    out[0] = bg[BG_ALPHA];
+    COMP_Y (out[1], bg[BG_RED], bg[BG_GREEN], bg[BG_BLUE]);
+    COMP_U (out[2], bg[BG_RED], bg[BG_GREEN], bg[BG_BLUE]);
+    COMP_V (out[3], bg[BG_RED], bg[BG_GREEN], bg[BG_BLUE]);
+    break;
+  case GST_VIDEO_FORMAT_ARGB:
+  case GST_VIDEO_FORMAT_xRGB:
+    out[0] = bg[BG_ALPHA];
+    out[1] = bg[BG_RED];
+    out[2] = bg[BG_GREEN];
+    out[3] = bg[BG_BLUE];
+    break;
+  case GST_VIDEO_FORMAT_ABGR:
+  case GST_VIDEO_FORMAT_xBGR:
+    out[0] = bg[BG_ALPHA];
+    out[1] = bg[BG_BLUE];
+    out[2] = bg[BG_GREEN];
+    out[3] = bg[BG_RED];
+    break;
+  case GST_VIDEO_FORMAT_BGRA:
+  case GST_VIDEO_FORMAT_BGRx:
+    out[0] = bg[BG_BLUE];
+    out[1] = bg[BG_GREEN];
+    out[2] = bg[BG_RED];
+    out[3] = bg[BG_ALPHA];
+    break;
+  case GST_VIDEO_FORMAT_RGBA:
+  case GST_VIDEO_FORMAT_RGBx:
+    out[0] = bg[BG_RED];
+    out[1] = bg[BG_GREEN];
+    out[2] = bg[BG_BLUE];
+    out[3] = bg[BG_ALPHA];
+    break;
+  case GST_VIDEO_FORMAT_BGR:
+    out[0] = bg[BG_BLUE];
+    out[1] = bg[BG_GREEN];
+    out[2] = bg[BG_RED];
+    break;
+  case GST_VIDEO_FORMAT_RGB:
+    out[0] = bg[BG_RED];
+    out[1] = bg[BG_GREEN];
+    out[2] = bg[BG_BLUE];
+    break;
+  default:
+    break;
+  }
+}
+
+/* Picks the kernels for the current formats, interpolation method and
+ * border, and converts the background color. Must be called whenever one
+ * of those changes. */
+void
+gst_kenburns_renderer_configure (GstKenburnsRenderer * r)
+{
+  gint layout, interp, border;
+
+  switch (r->src_fmt) {
+  case GST_VIDEO_FORMAT_I420:
+    layout = LAYOUT_I420;
+    break;
+  case GST_VIDEO_FORMAT_RGB:
+  case GST_VIDEO_FORMAT_BGR:
+    layout = LAYOUT_PACKED3;
+    break;
+  default:
+    layout = LAYOUT_PACKED4;
+    break;
+  }
+  interp = CLAMP (r->interp_method, 0, GST_KENBURNS_N_INTERP_METHODS - 1);
+  border = (r->border > 0);
+
+  r->kernel[FALSE][FALSE] = kernels[layout][interp][FALSE][border][FALSE];
+  r->kernel[FALSE][TRUE]  = kernels[layout][interp][FALSE][border][TRUE];
+  r->kernel[TRUE][FALSE]  = kernels[layout][interp][TRUE][border][FALSE];
+  r->kernel[TRUE][TRUE]   = kernels[layout][interp][TRUE][border][TRUE];
+  r->blur = blur_kernels[layout];
+  r->convert = converts[conv_class (r->src_fmt)][conv_class (r->dst_fmt)];
+  configure_bg (r);
+}
+
+/* Renders src into dst. With more than one mapping, the mappings are the
+ * sub-frame poses of a motion blurred frame, and their renderings are
+ * averaged. */
+void
+gst_kenburns_render (const GstKenburnsRenderer * r,
+    const GstKenburnsMapping * maps, gint n, const guint8 * src, guint8 * dst)
+{
+  const GstKenburnsFilter *filters;
+
+  n = MIN (n, MAX_BLUR_SAMPLES);
+  filters = filters_setup (r, maps, n);
+  if (r->src_fmt != r->dst_fmt)
+    render_converted (r, maps, n, filters, src, dst);
+  else if (n == 1 && GST_KENBURNS_TRACING)
+    render_traced (r, maps, filters, src, dst);
+  else
+    render_frame (r, maps, n, filters, src, dst);
+}
+
+/* Enlarges a plane factor times by repeating its pixels */
+KB_TEMPLATE
+enlarge_plane (const guint8 *in, gint in_stride, gint in_width, gint in_height,
+	       guint8 *out, gint out_stride, gint out_width, gint out_height,
+	       gint factor, const int bpp) {
+  const guint8 *row, *pix;
+  guint8 *o;
+  int x, y, sx, k, prev = -1;
+
+  for(y=0; y < out_height; y++) {
+    o = out + y * out_stride;
+    if (MIN (y / factor, in_height - 1) == prev) {
+      memcpy (o, o - out_stride, out_width * bpp);
+      continue;
+    }
+    prev = MIN (y / factor, in_height - 1);
+    row = in + prev * in_stride;
+    for(x=0, sx=0; x < out_width; sx++) {
+      pix = row + MIN (sx, in_width - 1) * bpp;
+      for(k=0; k < factor && x < out_width; k++, x++)
+	memcpy (o + x*bpp, pix, bpp);
+    }
+  }
+}
+
+/* Renders a quick draft of src into dst: nearest neighbor at 1/factor of
+ * the destination resolution, with the mapping scaled so that each draft
+ * pixel samples the center of the block it stands for, and then enlarged
+ * by repeating pixels. Motion blur is not drawn, and the border is rounded
+ * to whole draft pixels. */
+void
+gst_kenburns_render_draft (const GstKenburnsRenderer * r,
+    const GstKenburnsMapping * m, gint factor, const guint8 * src,
+    guint8 * dst)
+{
+  GstKenburnsRenderer draft = *r;
+  GstKenburnsMapping dm = *m;
+  GstVideoFormat fmt = r->dst_fmt;
+  gint i, nplanes, bpp, in_stride, out_stride;
+  const guint8 *in;
+  guint8 *small, *out;
+  gint64 t0;
+
+  if (factor <= 1) {
+    gst_kenburns_render (r, m, 1, src, dst);
+    return;
+  }
+
+  draft.dst_width  = (r->dst_width  + factor - 1) / factor;
+  draft.dst_height = (r->dst_height + factor - 1) / factor;
+  draft.border = (r->border + factor - 1) / factor;
+  draft.interp_method = GST_KENBURNS_INTERP_METHOD_NEAREST;
+  gst_kenburns_renderer_configure (&draft);
+
+  dm.xd0 = (m->xd0 + (factor - 1) / 2.0) / factor;
+  dm.yd0 = (m->yd0 + (factor - 1) / 2.0) / factor;
+  dm.zoomx = m->zoomx * factor;
+  dm.zoomy = m->zoomy * factor;
+
+  small = scratch_get (r, SCRATCH_DRAFT, gst_video_format_get_size (fmt,
+          draft.dst_width, draft.dst_height));
+  t0 = GST_KENBURNS_TRACE_NOW ();
+  gst_kenburns_render (&draft, &dm, 1, src, small);
+  GST_KENBURNS_TRACE_SPAN ("draft", t0, "factor", factor);
+
+  t0 = GST_KENBURNS_TRACE_NOW ();
+
+  nplanes = (fmt == GST_VIDEO_FORMAT_I420) ? 3 : 1;
+  for(i=0; i < nplanes; i++) {
+    bpp = gst_video_format_get_pixel_stride (fmt, i);
+    in  = small;
+    out = dst;
+    if (nplanes > 1) {
+      in  += gst_video_format_get_component_offset (fmt, i,
+          draft.dst_width, draft.dst_height);
+      out += gst_video_format_get_component_offset (fmt, i,
+          r->dst_width, r->dst_height);
+    }
+    in_stride  = gst_video_format_get_row_stride (fmt, i, draft.dst_width);
+    out_stride = gst_video_format_get_row_stride (fmt, i, r->dst_width);
+#define ENLARGE(bpp) \
+    enlarge_plane (in, in_stride, \
+        gst_video_format_get_component_width (fmt, i, draft.dst_width), \
+        gst_video_format_get_component_height (fmt, i, draft.dst_height), \
+        out, out_stride, \
+        gst_video_format_get_component_width (fmt, i, r->dst_width), \
+        gst_video_format_get_component_height (fmt, i, r->dst_height), \
+        factor, bpp)
+    switch (bpp) {
+    case 1:
+      ENLARGE (1);
+      break;
+    case 3:
+      ENLARGE (3);
+      break;
+    default:
+      ENLARGE (4);
+      break;
+    }
+#undef ENLARGE
+  }
+  GST_KENBURNS_TRACE_SPAN ("enlarge", t0, "factor", factor);
+}
+
+/* Crossfades from a, rendered with renderer ra and mapping ma, to b at mix
+ * (0 is all a, 1 is all b). Both renderers must have the same destination,
+ * in the format of their sources.
+ * The frame is rendered in bands of rows: a is written into a band, and b
+ * is sampled and blended into it while it is still in the cache. A side
+ * whose weight rounds to zero is not rendered at all. */
+void
+gst_kenburns_render_mix (const GstKenburnsRenderer * ra,
+    const GstKenburnsMapping * ma, const guint8 * a,
+    const GstKenburnsRenderer * rb, const GstKenburnsMapping * mb,
+    const guint8 * b, gdouble mix, guint8 * dst)
+{
+  GstKenburnsKernel ka, kb;
+  GstKenburnsFilter *filters;
+  gint weight, band, y;
+  gint64 t0;
+
+  weight = (gint) floor (CLAMP (mix, 0.0, 1.0) * 256 + 0.5);
+  if (weight == 0) {
+    gst_kenburns_render (ra, ma, 1, a, dst);
+    return;
+  }
+  if (weight == 256) {
+    gst_kenburns_render (rb, mb, 1, b, dst);
+    return;
+  }
+
+  ka = ra->kernel[ma->rotate ? TRUE : FALSE][FALSE];
+  kb = rb->kernel[mb->rotate ? TRUE : FALSE][TRUE];
+  /* the weight tables of both sides are kept in the work buffers of ra */
+  filters = scratch_get (ra, SCRATCH_FILTERS, 2 * sizeof (GstKenburnsFilter));
+  if (ra->interp_method != GST_KENBURNS_INTERP_METHOD_NEAREST)
+    filter_setup (ra, ma, &filters[0]);
+  if (rb->interp_method != GST_KENBURNS_INTERP_METHOD_NEAREST)
+    filter_setup (rb, mb, &filters[1]);
+  band = BAND_SIZE /
+      gst_video_format_get_row_stride (ra->dst_fmt, 0, ra->dst_width);
+  /* even, so that I420 chroma rows are not split */
+  band = MAX (band, 16) & ~1;
+  for(y=0; y < ra->dst_height; y += band) {
+    t0 = GST_KENBURNS_TRACE_NOW ();
+    ka (ra, ma, &filters[0], a, dst, y, MIN (y + band, ra->dst_height), 0);
+    kb (rb, mb, &filters[1], b, dst, y, MIN (y + band, ra->dst_height),
+        weight);
+    GST_KENBURNS_TRACE_SPAN ("band", t0, "y", y);
+  }
+}
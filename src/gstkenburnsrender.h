@@ -0,0 +1,178 @@
+/* GStreamer
+ * Copyright (C) <2011> Lane Brooks  <dirjud@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_KENBURNS_RENDER_H__
+#define __GST_KENBURNS_RENDER_H__
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+#include "gstkenburnsmotion.h"
+
+G_BEGIN_DECLS
+
+/**
+ * GstKenburnsInterpMethod:
+ * @GST_KENBURNS_INTERP_METHOD_NEAREST: uses nearest neighbor interpolation. This is the fastest method but can have aliasing artifacts.
+ * @GST_KENBURNS_INTERP_METHOD_BICUBIC: uses a 4x4 cubic convolution kernel. Without rotation the kernel is widened when zoomed out.
+ * @GST_KENBURNS_INTERP_METHOD_LANCZOS3: uses a 6x6 lanczos kernel, also widened when zoomed out without rotation. This is the highest quality and slowest method.
+ *
+ * Interpolation Method.
+ */
+typedef enum {
+  GST_KENBURNS_INTERP_METHOD_NEAREST,
+  GST_KENBURNS_INTERP_METHOD_BICUBIC,
+  GST_KENBURNS_INTERP_METHOD_LANCZOS3,
+} GstKenburnsInterpMethod;
+
+#define GST_KENBURNS_N_INTERP_METHODS 3
+
+#define GST_TYPE_KENBURNS_INTERP_METHOD (gst_kenburns_interp_method_get_type())
+GType gst_kenburns_interp_method_get_type (void);
+
+enum {
+  BG_ALPHA,
+  BG_RED,
+  BG_GREEN,
+  BG_BLUE,
+};
+
+#if 0
+#define FRAC gint64
+#define FRAC_WIDTH 12
+#define INT2FRAC(x)    (x << FRAC_WIDTH)
+#define DBL2FRAC(x)    ((int) (x*(1<< FRAC_WIDTH)))
+#define FRAC_MULT(x,y) ((x*y) >> FRAC_WIDTH)
+#define FRAC_DIV(x,y)  ((x<<FRAC_WIDTH)/y)
+#define FLOOR_FRAC(x)  (x >> FRAC_WIDTH)
+#define INC_FROM_ZERO  1
+#else
+#define FRAC double
+#define INT2FRAC(x)    ((double) x)
+#define DBL2FRAC(x)    (x)
+#define FRAC_MULT(x,y) (x*y)
+#define FRAC_DIV(x,y)  (x/y)
+#define FLOOR_FRAC(x)  ((int) floor(x))
+#define INC_FROM_ZERO  1e-9
+#endif
+
+/* The mapping from destination to source image coordinates for one pose.
+ * It is set up once per frame, or once per sub-frame sample when motion
+ * blur is enabled. */
+typedef struct {
+  gboolean rotate;
+  FRAC cos_thetax, sin_thetax;
+  FRAC cos_thetay, sin_thetay, tan_thetay;
+  FRAC cos_thetaz, sin_thetaz, tan_thetax_on_cos_thetay;
+  FRAC zoomx, zoomy, yd0, xd0, xs3, ys3, z1, zposx, zposy;
+} GstKenburnsMapping;
+
+typedef struct _GstKenburnsRenderer GstKenburnsRenderer;
+typedef struct _GstKenburnsScratch GstKenburnsScratch;
+struct _GstKenburnsFilter;
+
+/* renders the destination rows [y0, y1), blending them into what is
+ * there already with weight out of 256 for the blending kernels. filter
+ * is the weight table of m for the bicubic and lanczos3 kernels, built
+ * once per frame, and unused by the nearest neighbor kernels */
+typedef void (*GstKenburnsKernel) (const GstKenburnsRenderer *r,
+                                   const GstKenburnsMapping *m,
+                                   const struct _GstKenburnsFilter *filter,
+                                   const guint8 *src, guint8 *dst,
+                                   gint y0, gint y1, gint weight);
+typedef void (*GstKenburnsBlurKernel) (const GstKenburnsRenderer *r,
+                                       const GstKenburnsMapping *maps, gint n,
+                                       const guint8 *src, guint8 *dst);
+/* converts rows rows rendered into band, in the source format, to the
+ * destination rows from y0 on, putting the background components bg over
+ * the border */
+typedef void (*GstKenburnsConvertKernel) (const GstKenburnsRenderer *r,
+                                          const guint8 *band, guint8 *dst,
+                                          gint y0, gint rows,
+                                          const int bg[4]);
+
+/**
+ * GstKenburnsRenderer:
+ *
+ * Everything the render kernels need to know about the source and
+ * destination images. The kernels are specialized at compile time for
+ * each pixel layout, interpolation method, rotation and border setting,
+ * and for storing or blending (the second image of a crossfade), and
+ * gst_kenburns_renderer_configure() picks the ones to use whenever the
+ * caps or one of those properties change.
+ */
+struct _GstKenburnsRenderer {
+  GstVideoFormat src_fmt, dst_fmt;
+  gint32 src_width, src_height;
+  gint32 dst_width, dst_height;
+  gint32 border;
+  GstKenburnsInterpMethod interp_method;
+  guint32 bgcolor[4];
+
+  /* When upstream crops or reduces the source frames on request, the
+   * frames cover region_x, region_y, region_width x region_height of a
+   * full_width x full_height image, in full image pixels. The poses
+   * always refer to the full image. region_width is 0 otherwise. */
+  gint32 full_width, full_height;
+  gdouble region_x, region_y, region_width, region_height;
+
+  /* < private > */
+  guint8 bg[4];                 /* bgcolor in the destination format */
+  GstKenburnsKernel kernel[2][2]; /* indexed by GstKenburnsMapping.rotate
+                                   * and blending */
+  GstKenburnsBlurKernel blur;
+  GstKenburnsConvertKernel convert; /* from the source to the destination
+                                     * format */
+  GstKenburnsScratch *scratch;  /* work buffers of the rendering thread,
+                                 * see gstkenburnsrender.c */
+};
+
+void gst_kenburns_renderer_configure (GstKenburnsRenderer *r);
+
+GstKenburnsScratch *gst_kenburns_scratch_new (void);
+void gst_kenburns_scratch_free (GstKenburnsScratch *scratch);
+
+void gst_kenburns_mapping_setup (const GstKenburnsRenderer *r,
+                                 const GstKenburnsPose *pose,
+                                 GstKenburnsMapping *m);
+void gst_kenburns_mapping_crop (GstKenburnsMapping *m,
+                                gdouble x, gdouble y,
+                                gdouble sx, gdouble sy);
+void gst_kenburns_mapping_apply (const GstKenburnsMapping *m,
+                                 gdouble xdst, gdouble ydst,
+                                 gdouble *xsrc, gdouble *ysrc);
+void gst_kenburns_mapping_bounds (const GstKenburnsRenderer *r,
+                                  const GstKenburnsMapping *m,
+                                  gdouble rect[4], gdouble *scale);
+
+void gst_kenburns_render (const GstKenburnsRenderer *r,
+                          const GstKenburnsMapping *maps, gint n,
+                          const guint8 *src, guint8 *dst);
+void gst_kenburns_render_draft (const GstKenburnsRenderer *r,
+                                const GstKenburnsMapping *m, gint factor,
+                                const guint8 *src, guint8 *dst);
+void gst_kenburns_render_mix (const GstKenburnsRenderer *ra,
+                              const GstKenburnsMapping *ma, const guint8 *a,
+                              const GstKenburnsRenderer *rb,
+                              const GstKenburnsMapping *mb, const guint8 *b,
+                              gdouble mix, guint8 *dst);
+
+G_END_DECLS
+
+#endif /* __GST_KENBURNS_RENDER_H__ */
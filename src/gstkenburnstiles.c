@@ -0,0 +1,274 @@
+/* GStreamer
+ * Copyright (C) <2011> Lane Brooks  <dirjud@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Tiled image pyramids for the kenburns element.
+ *
+ * Each tile is mapped on its own the first time it is read and kept
+ * mapped in a least recently used cache of bounded size, so neither the
+ * address space nor the resident memory grow with the image. Tiles are
+ * whole pages for any reasonable tile size, but the mappings are aligned
+ * down to a page boundary anyway.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstkenburnstiles.h"
+#include "gstkenburnstrace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef struct {
+  gint64 key;
+  guint8 *map;
+  gsize map_size;
+  const guint8 *data;
+  GList link;
+} GstKenburnsTile;
+
+static const struct {
+  const gchar name[5];
+  GstVideoFormat format;
+} formats[] = {
+  { "RGBx", GST_VIDEO_FORMAT_RGBx },
+  { "BGRx", GST_VIDEO_FORMAT_BGRx },
+  { "xRGB", GST_VIDEO_FORMAT_xRGB },
+  { "xBGR", GST_VIDEO_FORMAT_xBGR },
+  { "RGBA", GST_VIDEO_FORMAT_RGBA },
+  { "BGRA", GST_VIDEO_FORMAT_BGRA },
+  { "ARGB", GST_VIDEO_FORMAT_ARGB },
+  { "ABGR", GST_VIDEO_FORMAT_ABGR },
+  { "AYUV", GST_VIDEO_FORMAT_AYUV },
+  { "RGB ", GST_VIDEO_FORMAT_RGB },
+  { "BGR ", GST_VIDEO_FORMAT_BGR },
+};
+
+#define TILES_ACROSS(tiles, size) \
+  (((size) + (tiles)->tile_size - 1) / (tiles)->tile_size)
+
+void
+gst_kenburns_tiles_level_size (const GstKenburnsTiles * tiles, gint level,
+    gint * width, gint * height)
+{
+  *width  = ((tiles->width  - 1) >> level) + 1;
+  *height = ((tiles->height - 1) >> level) + 1;
+}
+
+gboolean
+gst_kenburns_tiles_open (GstKenburnsTiles * tiles, const gchar * location,
+    guint cache_size, GError ** error)
+{
+  guint8 header[28];
+  struct stat st;
+  guint64 offset;
+  gint l, w, h;
+  guint i;
+
+  memset (tiles, 0, sizeof (*tiles));
+  tiles->fd = open (location, O_RDONLY);
+  if (tiles->fd < 0) {
+    g_set_error (error, GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_OPEN_READ,
+        "Could not open %s: %s", location, g_strerror (errno));
+    return FALSE;
+  }
+
+  if (read (tiles->fd, header, sizeof (header)) != sizeof (header) ||
+      memcmp (header, "KBTILES1", 8) != 0)
+    goto invalid;
+
+  tiles->format = GST_VIDEO_FORMAT_UNKNOWN;
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    if (memcmp (header + 8, formats[i].name, 4) == 0)
+      tiles->format = formats[i].format;
+  tiles->width     = GST_READ_UINT32_LE (header + 12);
+  tiles->height    = GST_READ_UINT32_LE (header + 16);
+  tiles->tile_size = GST_READ_UINT32_LE (header + 20);
+  tiles->levels    = GST_READ_UINT32_LE (header + 24);
+  if (tiles->format == GST_VIDEO_FORMAT_UNKNOWN ||
+      tiles->width <= 0 || tiles->height <= 0 ||
+      tiles->tile_size < 16 || tiles->tile_size > 8192 ||
+      tiles->levels < 1 ||
+      tiles->levels > (gint) G_N_ELEMENTS (tiles->level_offset))
+    goto invalid;
+
+  tiles->bpp = gst_video_format_get_pixel_stride (tiles->format, 0);
+  tiles->tile_bytes = (gsize) tiles->tile_size * tiles->tile_size * tiles->bpp;
+  offset = GST_KENBURNS_TILES_HEADER_SIZE;
+  for (l = 0; l < tiles->levels; l++) {
+    tiles->level_offset[l] = offset;
+    gst_kenburns_tiles_level_size (tiles, l, &w, &h);
+    offset += (guint64) TILES_ACROSS (tiles, w) * TILES_ACROSS (tiles, h) *
+        tiles->tile_bytes;
+  }
+  if (fstat (tiles->fd, &st) < 0 || (guint64) st.st_size < offset)
+    goto invalid;
+
+  /* the coarsest level is read whole when zoomed out all the way */
+  gst_kenburns_tiles_level_size (tiles, tiles->levels - 1, &w, &h);
+  if (w > GST_KENBURNS_TILES_MAX_COARSEST ||
+      h > GST_KENBURNS_TILES_MAX_COARSEST) {
+    g_set_error (error, GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_READ,
+        "The coarsest level of %s is %dx%d, at most %dx%d is supported",
+        location, w, h, GST_KENBURNS_TILES_MAX_COARSEST,
+        GST_KENBURNS_TILES_MAX_COARSEST);
+    close (tiles->fd);
+    tiles->fd = -1;
+    return FALSE;
+  }
+
+  tiles->page_size  = sysconf (_SC_PAGESIZE);
+  tiles->cache_size = MAX (cache_size, 1);
+  tiles->cache = g_hash_table_new (g_int64_hash, g_int64_equal);
+  g_queue_init (&tiles->lru);
+  return TRUE;
+
+invalid:
+  g_set_error (error, GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_READ,
+      "%s is not a complete tiled image", location);
+  close (tiles->fd);
+  tiles->fd = -1;
+  return FALSE;
+}
+
+static void
+tile_evict (GstKenburnsTiles * tiles)
+{
+  GList *link = g_queue_pop_tail_link (&tiles->lru);
+  GstKenburnsTile *tile = link->data;
+
+  g_hash_table_remove (tiles->cache, &tile->key);
+  munmap (tile->map, tile->map_size);
+  g_free (tile);
+}
+
+void
+gst_kenburns_tiles_close (GstKenburnsTiles * tiles)
+{
+  if (tiles->cache) {
+    while (tiles->lru.length > 0)
+      tile_evict (tiles);
+    g_hash_table_destroy (tiles->cache);
+    tiles->cache = NULL;
+  }
+  if (tiles->fd >= 0)
+    close (tiles->fd);
+  tiles->fd = -1;
+}
+
+/* Returns the pixels of tile (tx, ty) of level, or NULL if it could not be
+ * mapped. */
+static const guint8 *
+tile_get (GstKenburnsTiles * tiles, gint level, gint tx, gint ty)
+{
+  GstKenburnsTile *tile;
+  gint64 key = ((gint64) level << 48) | ((gint64) ty << 24) | tx;
+  guint64 offset, aligned;
+  gint64 t0 = GST_KENBURNS_TRACE_NOW ();
+  gint w, h;
+
+  tile = g_hash_table_lookup (tiles->cache, &key);
+  if (tile) {
+    g_queue_unlink (&tiles->lru, &tile->link);
+    g_queue_push_head_link (&tiles->lru, &tile->link);
+    GST_KENBURNS_TRACE_SPAN ("tile-hit", t0, "level", level);
+    return tile->data;
+  }
+
+  while (tiles->lru.length >= tiles->cache_size)
+    tile_evict (tiles);
+
+  gst_kenburns_tiles_level_size (tiles, level, &w, &h);
+  offset = tiles->level_offset[level] +
+      ((guint64) ty * TILES_ACROSS (tiles, w) + tx) * tiles->tile_bytes;
+  aligned = offset - offset % tiles->page_size;
+
+  tile = g_new (GstKenburnsTile, 1);
+  tile->key = key;
+  tile->map_size = tiles->tile_bytes + (offset - aligned);
+  tile->map = mmap (NULL, tile->map_size, PROT_READ, MAP_SHARED, tiles->fd,
+      aligned);
+  if (tile->map == MAP_FAILED) {
+    g_free (tile);
+    return NULL;
+  }
+  tile->data = tile->map + (offset - aligned);
+  tile->link.data = tile;
+  tile->link.prev = tile->link.next = NULL;
+  g_queue_push_head_link (&tiles->lru, &tile->link);
+  g_hash_table_insert (tiles->cache, &tile->key, tile);
+  GST_KENBURNS_TRACE_SPAN ("tile-miss", t0, "level", level);
+  return tile->data;
+}
+
+/* The destination pixels [*i0, *i1) of a read with step whose source
+ * pixels, x + i * step, lie in tile t. */
+#define TILE_SPAN(ts, t, x, step, n, i0, i1) \
+  { \
+      i0 = (MAX ((x), (t) * (ts)) - (x) + (step) - 1) / (step); \
+      i1 = MIN ((n), ((t) * (ts) + (ts) - (x) + (step) - 1) / (step)); \
+  }
+
+/* Copies width x height pixels of level, which must lie within it, to dst:
+ * pixel (i, j) of dst is pixel (x + i * step, y + j * step) of the level.
+ * Tiles that cannot be mapped read as zero, and tiles no pixel is read
+ * from are not mapped. */
+void
+gst_kenburns_tiles_read (GstKenburnsTiles * tiles, gint level, gint x, gint y,
+    gint width, gint height, gint step, guint8 * dst, gint dst_stride)
+{
+  gint ts = tiles->tile_size, bpp = tiles->bpp;
+  gint tx, ty, i0, i1, j0, j1, i, j;
+  const guint8 *data, *in;
+  guint8 *out;
+  gint64 t0;
+
+  for (ty = y / ts; ty <= (y + (height - 1) * step) / ts; ty++) {
+    TILE_SPAN (ts, ty, y, step, height, j0, j1);
+    if (j0 >= j1)
+      continue;
+    for (tx = x / ts; tx <= (x + (width - 1) * step) / ts; tx++) {
+      TILE_SPAN (ts, tx, x, step, width, i0, i1);
+      if (i0 >= i1)
+        continue;
+      t0 = GST_KENBURNS_TRACE_NOW ();
+      data = tile_get (tiles, level, tx, ty);
+      for (j = j0; j < j1; j++) {
+        out = dst + j * dst_stride + i0 * bpp;
+        if (data == NULL) {
+          memset (out, 0, (i1 - i0) * bpp);
+          continue;
+        }
+        in = data + ((y + j * step - ty * ts) * ts +
+            x + i0 * step - tx * ts) * bpp;
+        if (step == 1)
+          memcpy (out, in, (i1 - i0) * bpp);
+        else
+          for (i = i0; i < i1; i++, out += bpp, in += step * bpp)
+            memcpy (out, in, bpp);
+      }
+      GST_KENBURNS_TRACE_SPAN ("tile", t0, "level", level);
+    }
+  }
+}
@@ -0,0 +1,87 @@
+/* GStreamer
+ * Copyright (C) <2011> Lane Brooks  <dirjud@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_KENBURNS_TILES_H__
+#define __GST_KENBURNS_TILES_H__
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+G_BEGIN_DECLS
+
+/* the tiles start this far into the file */
+#define GST_KENBURNS_TILES_HEADER_SIZE 4096
+/* the largest width and height of the coarsest level */
+#define GST_KENBURNS_TILES_MAX_COARSEST 4096
+
+/**
+ * GstKenburnsTiles:
+ *
+ * An image pyramid far larger than a buffer, stored as raw tiles that are
+ * mapped on demand. The file starts with a GST_KENBURNS_TILES_HEADER_SIZE
+ * byte header, of which the rest is zero:
+ *
+ *   offset  0  "KBTILES1"
+ *   offset  8  the packed pixel format, named like the GstVideoFormat
+ *              ("RGBx", "BGRA", "AYUV", "RGB ", ...)
+ *   offset 12  width of the full image (32 bit little endian)
+ *   offset 16  height of the full image
+ *   offset 20  tile size, the tiles are square
+ *   offset 24  number of pyramid levels
+ *
+ * Level l is the full image reduced 2^l times, ceil(width / 2^l) by
+ * ceil(height / 2^l) pixels. The levels follow the header in order, each
+ * as its tiles in row major order, and each tile as tile size rows of tile
+ * size pixels. Tiles on the right and bottom edges are padded to full size.
+ * The pyramid must go down to a level of at most
+ * GST_KENBURNS_TILES_MAX_COARSEST pixels on each side.
+ *
+ * At most cache_size tiles are mapped at any time, the least recently used
+ * are unmapped first.
+ */
+typedef struct {
+  GstVideoFormat format;
+  gint width, height;
+  gint tile_size;
+  gint levels;
+  gint bpp;
+
+  /* < private > */
+  gint fd;
+  gsize page_size, tile_bytes;
+  guint64 level_offset[32];
+  guint cache_size;
+  GHashTable *cache;
+  GQueue lru;
+} GstKenburnsTiles;
+
+gboolean gst_kenburns_tiles_open  (GstKenburnsTiles *tiles,
+                                   const gchar *location, guint cache_size,
+                                   GError **error);
+void     gst_kenburns_tiles_close (GstKenburnsTiles *tiles);
+
+void     gst_kenburns_tiles_level_size (const GstKenburnsTiles *tiles,
+                                        gint level, gint *width, gint *height);
+void     gst_kenburns_tiles_read  (GstKenburnsTiles *tiles, gint level,
+                                   gint x, gint y, gint width, gint height,
+                                   gint step, guint8 *dst, gint dst_stride);
+
+G_END_DECLS
+
+#endif /* __GST_KENBURNS_TILES_H__ */
@@ -0,0 +1,177 @@
+/* GStreamer
+ * Copyright (C) <2011> Lane Brooks  <dirjud@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Chrome trace output of the kenburns trace points.
+ *
+ * The file is only opened, and truncated, with the first event, so that
+ * merely loading the plugin (gst-inspect, the registry scanner) leaves an
+ * earlier trace alone. The events are written as they end, one per line
+ * with the file line buffered, so a trace stays readable up to the last
+ * event when the process is killed; the closing bracket of the JSON array,
+ * which the Chrome trace format does not require, is written when the
+ * process exits normally. Threads carry their system thread id where
+ * there is one, and are numbered in the order of their first event
+ * otherwise.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstkenburnstrace.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+typedef struct {
+  gint tid;
+  GstClockTime frame;
+} GstKenburnsTraceThread;
+
+gboolean _gst_kenburns_trace_enabled = FALSE;
+
+static gchar *trace_location = NULL;
+static FILE *trace_file = NULL;
+static gint trace_pid;
+static guint64 trace_events = 0;
+static GStaticMutex trace_lock = G_STATIC_MUTEX_INIT;
+
+static GStaticPrivate trace_thread = G_STATIC_PRIVATE_INIT;
+#ifndef SYS_gettid
+static volatile gint trace_threads = 0;
+#endif
+
+/* Enables the trace points when GST_KENBURNS_TRACE names a file. Called
+ * once when the plugin is loaded. */
+void
+gst_kenburns_trace_init (void)
+{
+  const gchar *location = g_getenv ("GST_KENBURNS_TRACE");
+
+  if (location == NULL || *location == '\0' || trace_location != NULL)
+    return;
+
+  trace_location = g_strdup (location);
+  _gst_kenburns_trace_enabled = TRUE;
+}
+
+/* Terminates the JSON array and closes the file at exit. */
+static void
+trace_close (void)
+{
+  g_static_mutex_lock (&trace_lock);
+  _gst_kenburns_trace_enabled = FALSE;
+  if (trace_file != NULL) {
+    fputs ("]\n", trace_file);
+    fclose (trace_file);
+    trace_file = NULL;
+  }
+  g_static_mutex_unlock (&trace_lock);
+}
+
+/* Opens the file for the first event. Must be called with trace_lock
+ * held. Returns FALSE, and disables the trace points, when it can not be
+ * opened. */
+static gboolean
+trace_open (void)
+{
+  if (trace_file != NULL)
+    return TRUE;
+  if (!_gst_kenburns_trace_enabled)
+    return FALSE;
+
+  trace_file = fopen (trace_location, "w");
+  if (trace_file == NULL) {
+    g_warning ("kenburns: could not open trace file %s: %s", trace_location,
+        g_strerror (errno));
+    _gst_kenburns_trace_enabled = FALSE;
+    return FALSE;
+  }
+  setvbuf (trace_file, NULL, _IOLBF, 0);
+  trace_pid = getpid ();
+  fputs ("[\n", trace_file);
+  atexit (trace_close);
+  return TRUE;
+}
+
+static GstKenburnsTraceThread *
+trace_thread_get (void)
+{
+  GstKenburnsTraceThread *t = g_static_private_get (&trace_thread);
+
+  if (t == NULL) {
+    t = g_new (GstKenburnsTraceThread, 1);
+#ifdef SYS_gettid
+    t->tid = (gint) syscall (SYS_gettid);
+#else
+    t->tid = g_atomic_int_exchange_and_add (&trace_threads, 1) + 1;
+#endif
+    t->frame = GST_CLOCK_TIME_NONE;
+    g_static_private_set (&trace_thread, t, g_free);
+  }
+  return t;
+}
+
+/* in nanoseconds, like the clock the spans are written in microseconds of */
+gint64
+_gst_kenburns_trace_now (void)
+{
+  return gst_util_get_timestamp ();
+}
+
+void
+_gst_kenburns_trace_frame (GstClockTime ts)
+{
+  trace_thread_get ()->frame = ts;
+}
+
+/* Writes a complete event from start to now. */
+void
+_gst_kenburns_trace_span (const gchar * name, gint64 start,
+    const gchar * arg_name, gint64 arg)
+{
+  gint64 end = _gst_kenburns_trace_now ();
+  GstKenburnsTraceThread *t = trace_thread_get ();
+  gchar frame[24];
+
+  if (GST_CLOCK_TIME_IS_VALID (t->frame))
+    g_snprintf (frame, sizeof (frame), "%" G_GUINT64_FORMAT, t->frame);
+  else
+    strcpy (frame, "null");
+
+  g_static_mutex_lock (&trace_lock);
+  if (!trace_open ()) {
+    g_static_mutex_unlock (&trace_lock);
+    return;
+  }
+  fprintf (trace_file, "%s{\"name\":\"%s\",\"cat\":\"kenburns\",\"ph\":\"X\","
+      "\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+      "\"args\":{\"frame\":%s", trace_events++ ? "," : "", name, trace_pid,
+      t->tid, start / 1000.0, (end - start) / 1000.0, frame);
+  if (arg_name)
+    fprintf (trace_file, ",\"%s\":%" G_GINT64_FORMAT, arg_name, arg);
+  fputs ("}}\n", trace_file);
+  g_static_mutex_unlock (&trace_lock);
+}
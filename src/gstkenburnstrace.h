@@ -0,0 +1,76 @@
+/* GStreamer
+ * Copyright (C) <2011> Lane Brooks  <dirjud@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_KENBURNS_TRACE_H__
+#define __GST_KENBURNS_TRACE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* Trace points of the render path. When the GST_KENBURNS_TRACE environment
+ * variable names a file at plugin load, the file is created with the first
+ * span and every span is appended to it as a Chrome trace event (JSON
+ * array format, for chrome://tracing or Perfetto) with the thread it ran
+ * on and the timestamp of the frame it belongs to.
+ * Otherwise a trace point costs a test of a global flag, and nothing at
+ * all when GStreamer debugging is compiled out.
+ *
+ * A span is timed with
+ *
+ *   t0 = GST_KENBURNS_TRACE_NOW ();
+ *   ...
+ *   GST_KENBURNS_TRACE_SPAN ("band", t0, "y", y);
+ *
+ * and GST_KENBURNS_TRACE_FRAME() sets the frame the following spans of the
+ * calling thread are tagged with.
+ */
+
+extern gboolean _gst_kenburns_trace_enabled;
+
+void gst_kenburns_trace_init (void);
+
+gint64 _gst_kenburns_trace_now (void);
+void _gst_kenburns_trace_frame (GstClockTime ts);
+void _gst_kenburns_trace_span (const gchar *name, gint64 start,
+                               const gchar *arg_name, gint64 arg);
+
+#ifndef GST_DISABLE_GST_DEBUG
+#define GST_KENBURNS_TRACING G_UNLIKELY (_gst_kenburns_trace_enabled)
+#else
+#define GST_KENBURNS_TRACING FALSE
+#endif
+
+#define GST_KENBURNS_TRACE_NOW() \
+  (GST_KENBURNS_TRACING ? _gst_kenburns_trace_now () : 0)
+
+#define GST_KENBURNS_TRACE_FRAME(ts) G_STMT_START { \
+    if (GST_KENBURNS_TRACING) \
+      _gst_kenburns_trace_frame (ts); \
+  } G_STMT_END
+
+/* arg_name can be NULL for spans without an argument */
+#define GST_KENBURNS_TRACE_SPAN(name, start, arg_name, arg) G_STMT_START { \
+    if (GST_KENBURNS_TRACING) \
+      _gst_kenburns_trace_span (name, start, arg_name, arg); \
+  } G_STMT_END
+
+G_END_DECLS
+
+#endif /* __GST_KENBURNS_TRACE_H__ */
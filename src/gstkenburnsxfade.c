@@ -0,0 +1,805 @@
+/* GStreamer
+ * Copyright (C) <2011> Lane Brooks  <dirjud@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:element-kenburnsxfade
+ *
+ * kenburnsxfade crossfades between two images, each shown in its own
+ * pose like kenburns would show it. The mix property goes from 0 (only
+ * the image on sink_0) to 1 (only the image on sink_1), and the pose of
+ * each image is set with the xpos, ypos, zpos, xrot, yrot, zrot and fov
+ * properties of its sink pad. All of them can be controlled via
+ * GstControllers.
+ *
+ * Both images are sampled for every output pixel and blended straight
+ * into the output, so a transition costs no more memory traffic than
+ * rendering a single image. At the ends of the transition, where the
+ * weight of one image is zero, that image is not sampled at all.
+ *
+ * The inputs must have the same format but can have any size, and the
+ * output size is set by downstream. Frames are taken from both inputs in
+ * pairs, so the inputs should have the same frame rate. When one input
+ * ends, its last frame keeps being shown until the other one ends too.
+ * A seek is sent to both inputs, and the output follows the segment of
+ * the inputs.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch kenburnsxfade name=x sink_1::zpos=0.5 ! video/x-raw-yuv,width=640,height=480 ! autovideosink  filesrc location=a.jpg ! decodebin2 ! ffmpegcolorspace ! imagefreeze ! x.sink_0  filesrc location=b.jpg ! decodebin2 ! ffmpegcolorspace ! imagefreeze ! x.sink_1
+ * ]| Shows a.jpg and b.jpg zoomed in two times. Controllers on mix and
+ * on the poses of the pads turn this into a transition.
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstkenburnsxfade.h"
+#include "gstkenburnstrace.h"
+
+#include <string.h>
+#include <gst/controller/gstcontroller.h>
+
+#define DEFAULT_MIX 0.0
+#define DEFAULT_XPOS 0.0
+#define DEFAULT_YPOS 0.0
+#define DEFAULT_ZPOS 1.0
+#define DEFAULT_XROT 0.0
+#define DEFAULT_YROT 0.0
+#define DEFAULT_ZROT 0.0
+#define DEFAULT_FOV 60
+#define DEFAULT_INTERP_METHOD GST_KENBURNS_INTERP_METHOD_NEAREST
+#define DEFAULT_BORDER 0
+#define DEFAULT_BGCOLOR 0x00000000
+
+enum
+{
+  PROP_PAD_0,
+  PROP_PAD_XPOS,
+  PROP_PAD_YPOS,
+  PROP_PAD_ZPOS,
+  PROP_PAD_XROT,
+  PROP_PAD_YROT,
+  PROP_PAD_ZROT,
+  PROP_PAD_FOV,
+};
+
+enum
+{
+  PROP_0,
+  PROP_MIX,
+  PROP_INTERP_METHOD,
+  PROP_BORDER,
+  PROP_BGCOLOR,
+};
+
+GST_DEBUG_CATEGORY_STATIC (gst_kenburns_xfade_debug);
+#define GST_CAT_DEFAULT gst_kenburns_xfade_debug
+
+#define KENBURNS_XFADE_CAPS \
+    GST_VIDEO_CAPS_YUV ("{AYUV, I420}") ";" \
+    GST_VIDEO_CAPS_BGRA ";" \
+    GST_VIDEO_CAPS_ARGB ";" \
+    GST_VIDEO_CAPS_RGBA ";" \
+    GST_VIDEO_CAPS_ABGR ";" \
+    GST_VIDEO_CAPS_RGB ";" \
+    GST_VIDEO_CAPS_BGR ";" \
+    GST_VIDEO_CAPS_xRGB ";" \
+    GST_VIDEO_CAPS_xBGR ";" \
+    GST_VIDEO_CAPS_RGBx ";" \
+    GST_VIDEO_CAPS_BGRx
+
+static GstStaticPadTemplate gst_kenburns_xfade_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (KENBURNS_XFADE_CAPS));
+
+static GstStaticPadTemplate gst_kenburns_xfade_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink_%d",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (KENBURNS_XFADE_CAPS));
+
+/* GstKenburnsXfadePad */
+
+G_DEFINE_TYPE (GstKenburnsXfadePad, gst_kenburns_xfade_pad, GST_TYPE_PAD);
+
+static void
+gst_kenburns_xfade_pad_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstKenburnsXfadePad *pad = GST_KENBURNS_XFADE_PAD (object);
+
+  GST_OBJECT_LOCK (pad);
+  switch (prop_id) {
+    case PROP_PAD_XPOS:
+      pad->pose.xpos = g_value_get_double (value);
+      break;
+    case PROP_PAD_YPOS:
+      pad->pose.ypos = g_value_get_double (value);
+      break;
+    case PROP_PAD_ZPOS:
+      pad->pose.zpos = g_value_get_double (value);
+      break;
+    case PROP_PAD_XROT:
+      pad->pose.xrot = g_value_get_double (value);
+      break;
+    case PROP_PAD_YROT:
+      pad->pose.yrot = g_value_get_double (value);
+      break;
+    case PROP_PAD_ZROT:
+      pad->pose.zrot = g_value_get_double (value);
+      break;
+    case PROP_PAD_FOV:
+      pad->pose.fov = g_value_get_double (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (pad);
+}
+
+static void
+gst_kenburns_xfade_pad_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstKenburnsXfadePad *pad = GST_KENBURNS_XFADE_PAD (object);
+
+  GST_OBJECT_LOCK (pad);
+  switch (prop_id) {
+    case PROP_PAD_XPOS:
+      g_value_set_double (value, pad->pose.xpos);
+      break;
+    case PROP_PAD_YPOS:
+      g_value_set_double (value, pad->pose.ypos);
+      break;
+    case PROP_PAD_ZPOS:
+      g_value_set_double (value, pad->pose.zpos);
+      break;
+    case PROP_PAD_XROT:
+      g_value_set_double (value, pad->pose.xrot);
+      break;
+    case PROP_PAD_YROT:
+      g_value_set_double (value, pad->pose.yrot);
+      break;
+    case PROP_PAD_ZROT:
+      g_value_set_double (value, pad->pose.zrot);
+      break;
+    case PROP_PAD_FOV:
+      g_value_set_double (value, pad->pose.fov);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (pad);
+}
+
+static void
+gst_kenburns_xfade_pad_finalize (GObject * object)
+{
+  GstKenburnsXfadePad *pad = GST_KENBURNS_XFADE_PAD (object);
+
+  gst_kenburns_scratch_free (pad->scratch);
+
+  G_OBJECT_CLASS (gst_kenburns_xfade_pad_parent_class)->finalize (object);
+}
+
+static void
+gst_kenburns_xfade_pad_class_init (GstKenburnsXfadePadClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+
+  gobject_class->set_property = gst_kenburns_xfade_pad_set_property;
+  gobject_class->get_property = gst_kenburns_xfade_pad_get_property;
+  gobject_class->finalize = gst_kenburns_xfade_pad_finalize;
+
+  g_object_class_install_property (gobject_class, PROP_PAD_XPOS,
+      g_param_spec_double ("xpos", "x viewing position",
+          "Horizontal position of the center of the output on the image of this pad, see kenburns.",
+          -G_MAXDOUBLE, G_MAXDOUBLE, DEFAULT_XPOS,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE));
+  g_object_class_install_property (gobject_class, PROP_PAD_YPOS,
+      g_param_spec_double ("ypos", "y viewing position",
+          "Vertical position of the center of the output on the image of this pad, see kenburns.",
+          -G_MAXDOUBLE, G_MAXDOUBLE, DEFAULT_YPOS,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE));
+  g_object_class_install_property (gobject_class, PROP_PAD_ZPOS,
+      g_param_spec_double ("zpos", "z viewing position",
+          "z=1.0 corresponds to the viewing distance to see the image of this pad letterboxed at the output.",
+          0.001, G_MAXDOUBLE, DEFAULT_ZPOS,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE));
+  g_object_class_install_property (gobject_class, PROP_PAD_XROT,
+      g_param_spec_double ("xrot", "roation about x axis",
+          "Rotation of the image of this pad about the x-axis in degrees about its center.",
+          -G_MAXDOUBLE, G_MAXDOUBLE, DEFAULT_XROT,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE));
+  g_object_class_install_property (gobject_class, PROP_PAD_YROT,
+      g_param_spec_double ("yrot", "roation about y axis",
+          "Rotation of the image of this pad about the y-axis in degrees about its center.",
+          -G_MAXDOUBLE, G_MAXDOUBLE, DEFAULT_YROT,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE));
+  g_object_class_install_property (gobject_class, PROP_PAD_ZROT,
+      g_param_spec_double ("zrot", "roation about z axis",
+          "Rotation of the image of this pad about the z-axis in degrees about its center.",
+          -G_MAXDOUBLE, G_MAXDOUBLE, DEFAULT_ZROT,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE));
+  g_object_class_install_property (gobject_class, PROP_PAD_FOV,
+      g_param_spec_double ("fov", "Field of View Angle",
+          "Total angle in field of view.",
+          0.001, 180, DEFAULT_FOV,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE));
+}
+
+static void
+gst_kenburns_xfade_pad_init (GstKenburnsXfadePad * pad)
+{
+  pad->pose.xpos = DEFAULT_XPOS;
+  pad->pose.ypos = DEFAULT_YPOS;
+  pad->pose.zpos = DEFAULT_ZPOS;
+  pad->pose.xrot = DEFAULT_XROT;
+  pad->pose.yrot = DEFAULT_YROT;
+  pad->pose.zrot = DEFAULT_ZROT;
+  pad->pose.fov = DEFAULT_FOV;
+  pad->scratch = gst_kenburns_scratch_new ();
+}
+
+/* GstKenburnsXfade */
+
+GST_BOILERPLATE (GstKenburnsXfade, gst_kenburns_xfade, GstElement,
+    GST_TYPE_ELEMENT);
+
+/* Copies the shared settings to the renderers of both pads and picks
+ * their kernels. Must be called with the object lock held. */
+static void
+gst_kenburns_xfade_configure (GstKenburnsXfade * xf)
+{
+  GstKenburnsRenderer *r;
+  gint i;
+
+  for (i = 0; i < 2; i++) {
+    r = &xf->sinkpad[i]->renderer;
+    r->interp_method = xf->interp_method;
+    r->border = xf->border;
+    memcpy (r->bgcolor, xf->bgcolor, sizeof (r->bgcolor));
+    gst_kenburns_renderer_configure (r);
+  }
+}
+
+/* Offers the format of the other input, if it has one, in any size. */
+static GstCaps *
+gst_kenburns_xfade_sink_getcaps (GstPad * pad)
+{
+  GstKenburnsXfade *xf = GST_KENBURNS_XFADE (gst_pad_get_parent (pad));
+  GstPad *other;
+  GstCaps *caps, *tmp;
+  GstStructure *s;
+
+  other = GST_PAD (xf->sinkpad[(GST_PAD (xf->sinkpad[0]) == pad) ? 1 : 0]);
+  caps = gst_pad_get_negotiated_caps (other);
+  if (caps) {
+    tmp = gst_caps_make_writable (caps);
+    s = gst_caps_get_structure (tmp, 0);
+    gst_structure_remove_fields (s, "width", "height", "framerate", NULL);
+    caps = gst_caps_intersect (tmp, gst_pad_get_pad_template_caps (pad));
+    gst_caps_unref (tmp);
+  } else {
+    caps = gst_caps_copy (gst_pad_get_pad_template_caps (pad));
+  }
+
+  gst_object_unref (xf);
+  return caps;
+}
+
+static gboolean
+gst_kenburns_xfade_sink_setcaps (GstPad * pad, GstCaps * caps)
+{
+  GstKenburnsXfade *xf = GST_KENBURNS_XFADE (gst_pad_get_parent (pad));
+  GstKenburnsXfadePad *xpad = GST_KENBURNS_XFADE_PAD (pad);
+  GstKenburnsXfadePad *other;
+  GstVideoFormat format;
+  gint width, height, fps_n, fps_d;
+  gboolean ret = FALSE;
+
+  if (!gst_video_format_parse_caps (caps, &format, &width, &height)) {
+    GST_ERROR_OBJECT (pad, "Invalid caps: %" GST_PTR_FORMAT, caps);
+    goto done;
+  }
+
+  GST_OBJECT_LOCK (xf);
+  other = xf->sinkpad[(xf->sinkpad[0] == xpad) ? 1 : 0];
+  if (other->have_caps && other->renderer.src_fmt != format) {
+    GST_OBJECT_UNLOCK (xf);
+    GST_ERROR_OBJECT (pad, "Both inputs must have the same format");
+    goto done;
+  }
+  xpad->renderer.src_fmt = format;
+  xpad->renderer.dst_fmt = format;
+  xpad->renderer.src_width = width;
+  xpad->renderer.src_height = height;
+  xpad->have_caps = TRUE;
+  if (gst_video_parse_caps_framerate (caps, &fps_n, &fps_d) &&
+      (xpad == xf->sinkpad[0] || !other->have_caps)) {
+    xf->fps_n = fps_n;
+    xf->fps_d = fps_d;
+  }
+  xf->negotiated = FALSE;
+  gst_kenburns_xfade_configure (xf);
+  GST_OBJECT_UNLOCK (xf);
+  ret = TRUE;
+
+done:
+  gst_object_unref (xf);
+  return ret;
+}
+
+/* Sets the output caps: the format and frame rate of the inputs, in the
+ * size downstream prefers, or else the size of the first input. */
+static gboolean
+gst_kenburns_xfade_negotiate (GstKenburnsXfade * xf, GstKenburnsXfadePad * in)
+{
+  GstCaps *caps, *peer, *tmp;
+  GstStructure *s;
+  GstVideoFormat format;
+  gint width, height, i;
+
+  caps = gst_caps_copy (GST_PAD_CAPS (in));
+  s = gst_caps_get_structure (caps, 0);
+  gst_structure_set (s,
+      "width", GST_TYPE_INT_RANGE, 1, G_MAXINT,
+      "height", GST_TYPE_INT_RANGE, 1, G_MAXINT, NULL);
+  if (xf->fps_n > 0)
+    gst_structure_set (s, "framerate", GST_TYPE_FRACTION, xf->fps_n, xf->fps_d,
+        NULL);
+
+  peer = gst_pad_peer_get_caps (xf->srcpad);
+  if (peer) {
+    tmp = gst_caps_intersect (caps, peer);
+    gst_caps_unref (caps);
+    gst_caps_unref (peer);
+    caps = tmp;
+  }
+  if (gst_caps_is_empty (caps)) {
+    gst_caps_unref (caps);
+    return FALSE;
+  }
+
+  gst_caps_truncate (caps);
+  s = gst_caps_get_structure (caps, 0);
+  gst_structure_fixate_field_nearest_int (s, "width", in->renderer.src_width);
+  gst_structure_fixate_field_nearest_int (s, "height",
+      in->renderer.src_height);
+  gst_pad_fixate_caps (xf->srcpad, caps);
+
+  if (!gst_video_format_parse_caps (caps, &format, &width, &height) ||
+      !gst_pad_set_caps (xf->srcpad, caps)) {
+    gst_caps_unref (caps);
+    return FALSE;
+  }
+  GST_DEBUG_OBJECT (xf, "output caps %" GST_PTR_FORMAT, caps);
+  gst_caps_unref (caps);
+
+  GST_OBJECT_LOCK (xf);
+  xf->format = format;
+  xf->width = width;
+  xf->height = height;
+  for (i = 0; i < 2; i++) {
+    xf->sinkpad[i]->renderer.dst_width = width;
+    xf->sinkpad[i]->renderer.dst_height = height;
+  }
+  xf->negotiated = TRUE;
+  GST_OBJECT_UNLOCK (xf);
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_kenburns_xfade_collected (GstCollectPads * pads, gpointer user_data)
+{
+  GstKenburnsXfade *xf = GST_KENBURNS_XFADE (user_data);
+  GstKenburnsXfadePad *pad;
+  GstKenburnsRenderer r[2];
+  GstKenburnsMapping maps[2];
+  GstKenburnsPose pose;
+  GstBuffer *in[2] = { NULL, NULL }, *buf, *out = NULL;
+  GstClockTime ts = GST_CLOCK_TIME_NONE, duration = GST_CLOCK_TIME_NONE;
+  GstSegment segment;
+  GstFlowReturn ret;
+  gboolean have[2] = { FALSE, FALSE };
+  gboolean segment_pending, update;
+  gdouble mix;
+  gint64 t0, t1;
+  gint i;
+
+  for (i = 0; i < 2; i++) {
+    pad = xf->sinkpad[i];
+    buf = gst_collect_pads_pop (pads, pad->collect);
+    if (buf) {
+      if (!GST_CLOCK_TIME_IS_VALID (ts)) {
+        ts = GST_BUFFER_TIMESTAMP (buf);
+        duration = GST_BUFFER_DURATION (buf);
+      }
+      gst_buffer_replace (&pad->last, buf);
+      gst_buffer_unref (buf);
+    } else if (pad->last == NULL || !pad->have_caps) {
+      continue;
+    }
+    in[i] = pad->last;
+    have[i] = buf != NULL;
+  }
+  if (!have[0] && !have[1]) {
+    GST_DEBUG_OBJECT (xf, "both inputs ended");
+    gst_pad_push_event (xf->srcpad, gst_event_new_eos ());
+    return GST_FLOW_UNEXPECTED;
+  }
+
+  if (!xf->negotiated &&
+      !gst_kenburns_xfade_negotiate (xf, xf->sinkpad[have[0] ? 0 : 1])) {
+    GST_ELEMENT_ERROR (xf, CORE, NEGOTIATION, (NULL),
+        ("No output format could be agreed on"));
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+
+  GST_OBJECT_LOCK (xf);
+  segment_pending = xf->segment_pending;
+  update = xf->segment_update;
+  xf->segment_pending = FALSE;
+  GST_OBJECT_UNLOCK (xf);
+  if (segment_pending) {
+    /* the output is timestamped like the inputs, so it goes out in their
+     * segment. Downstream accumulates the running time over the segments
+     * the same way collectpads did on the sink pad. */
+    GST_OBJECT_LOCK (pads);
+    segment = xf->sinkpad[have[0] ? 0 : 1]->collect->segment;
+    GST_OBJECT_UNLOCK (pads);
+    gst_pad_push_event (xf->srcpad,
+        gst_event_new_new_segment_full (update, segment.rate,
+            segment.applied_rate, GST_FORMAT_TIME, segment.start,
+            segment.stop, segment.time));
+  }
+
+  ret = gst_pad_alloc_buffer_and_set_caps (xf->srcpad, GST_BUFFER_OFFSET_NONE,
+      gst_video_format_get_size (xf->format, xf->width, xf->height),
+      GST_PAD_CAPS (xf->srcpad), &out);
+  if (ret != GST_FLOW_OK)
+    return ret;
+  GST_BUFFER_TIMESTAMP (out) = ts;
+  GST_BUFFER_DURATION (out) = duration;
+
+  GST_KENBURNS_TRACE_FRAME (ts);
+  t0 = GST_KENBURNS_TRACE_NOW ();
+
+  if (GST_CLOCK_TIME_IS_VALID (ts)) {
+    gst_object_sync_values (G_OBJECT (xf), ts);
+    for (i = 0; i < 2; i++)
+      gst_object_sync_values (G_OBJECT (xf->sinkpad[i]), ts);
+  }
+
+  /* rendered from copies of the renderers, so that the properties can be
+   * set meanwhile, with work buffers only this thread uses */
+  GST_OBJECT_LOCK (xf);
+  for (i = 0; i < 2; i++) {
+    r[i] = xf->sinkpad[i]->renderer;
+    r[i].scratch = xf->sinkpad[i]->scratch;
+  }
+  /* an input that never had a frame does not take part */
+  mix = !in[0] ? 1.0 : !in[1] ? 0.0 : xf->mix;
+  GST_OBJECT_UNLOCK (xf);
+
+  for (i = 0; i < 2; i++) {
+    pad = xf->sinkpad[i];
+    GST_OBJECT_LOCK (pad);
+    pose = pad->pose;
+    GST_OBJECT_UNLOCK (pad);
+    if (in[i])
+      gst_kenburns_mapping_setup (&r[i], &pose, &maps[i]);
+  }
+
+  GST_KENBURNS_TRACE_SPAN ("setup", t0, NULL, 0);
+
+  t1 = GST_KENBURNS_TRACE_NOW ();
+  gst_kenburns_render_mix (&r[0], &maps[0],
+      in[0] ? GST_BUFFER_DATA (in[0]) : NULL, &r[1], &maps[1],
+      in[1] ? GST_BUFFER_DATA (in[1]) : NULL, mix, GST_BUFFER_DATA (out));
+  GST_KENBURNS_TRACE_SPAN ("render", t1, NULL, 0);
+  GST_KENBURNS_TRACE_SPAN ("frame", t0, NULL, 0);
+
+  return gst_pad_push (xf->srcpad, out);
+}
+
+/* collectpads takes the new segments of the sink pads and leaves the
+ * output segment to the element, so a new one is pushed after each of them
+ * and after a flush. */
+static gboolean
+gst_kenburns_xfade_sink_event (GstPad * pad, GstEvent * event)
+{
+  GstKenburnsXfade *xf = GST_KENBURNS_XFADE (gst_pad_get_parent (pad));
+  gboolean update, ret;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_FLUSH_STOP:
+      GST_OBJECT_LOCK (xf);
+      xf->segment_pending = TRUE;
+      xf->segment_update = FALSE;
+      GST_OBJECT_UNLOCK (xf);
+      break;
+    case GST_EVENT_NEWSEGMENT:
+      gst_event_parse_new_segment (event, &update, NULL, NULL, NULL, NULL,
+          NULL);
+      GST_OBJECT_LOCK (xf);
+      xf->segment_update = update &&
+          (xf->segment_update || !xf->segment_pending);
+      xf->segment_pending = TRUE;
+      GST_OBJECT_UNLOCK (xf);
+      break;
+    default:
+      break;
+  }
+  ret = xf->collect_event (pad, event);
+
+  gst_object_unref (xf);
+  return ret;
+}
+
+/* Seeks both inputs, the new segment follows from the segments they send
+ * next. */
+static gboolean
+gst_kenburns_xfade_src_event (GstPad * pad, GstEvent * event)
+{
+  GstKenburnsXfade *xf = GST_KENBURNS_XFADE (gst_pad_get_parent (pad));
+  gboolean ret = TRUE;
+  gint i;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_SEEK:
+      GST_DEBUG_OBJECT (xf, "seeking both inputs");
+      for (i = 0; i < 2; i++) {
+        if (!gst_pad_push_event (GST_PAD (xf->sinkpad[i]),
+                gst_event_ref (event)))
+          ret = FALSE;
+      }
+      GST_OBJECT_LOCK (xf);
+      xf->segment_pending = TRUE;
+      xf->segment_update = FALSE;
+      GST_OBJECT_UNLOCK (xf);
+      gst_event_unref (event);
+      break;
+    default:
+      ret = gst_pad_event_default (pad, event);
+      break;
+  }
+
+  gst_object_unref (xf);
+  return ret;
+}
+
+static GstStateChangeReturn
+gst_kenburns_xfade_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstKenburnsXfade *xf = GST_KENBURNS_XFADE (element);
+  GstStateChangeReturn ret;
+  gint i;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      xf->segment_pending = TRUE;
+      xf->segment_update = FALSE;
+      gst_collect_pads_start (xf->collect);
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* the streaming thread must be stopped before chaining up */
+      gst_collect_pads_stop (xf->collect);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY) {
+    for (i = 0; i < 2; i++)
+      gst_buffer_replace (&xf->sinkpad[i]->last, NULL);
+  }
+  return ret;
+}
+
+static void
+gst_kenburns_xfade_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstKenburnsXfade *xf = GST_KENBURNS_XFADE (object);
+  guint bgcolor;
+
+  GST_OBJECT_LOCK (xf);
+  switch (prop_id) {
+    case PROP_MIX:
+      xf->mix = g_value_get_double (value);
+      break;
+    case PROP_INTERP_METHOD:
+      xf->interp_method = g_value_get_enum (value);
+      gst_kenburns_xfade_configure (xf);
+      break;
+    case PROP_BORDER:
+      xf->border = g_value_get_int (value);
+      gst_kenburns_xfade_configure (xf);
+      break;
+    case PROP_BGCOLOR:
+      bgcolor = g_value_get_uint (value);
+      xf->bgcolor[BG_ALPHA] = (bgcolor >> 24) & 0xFF;
+      xf->bgcolor[BG_RED] = (bgcolor >> 16) & 0xFF;
+      xf->bgcolor[BG_GREEN] = (bgcolor >> 8) & 0xFF;
+      xf->bgcolor[BG_BLUE] = (bgcolor >> 0) & 0xFF;
+      gst_kenburns_xfade_configure (xf);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (xf);
+}
+
+static void
+gst_kenburns_xfade_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstKenburnsXfade *xf = GST_KENBURNS_XFADE (object);
+
+  GST_OBJECT_LOCK (xf);
+  switch (prop_id) {
+    case PROP_MIX:
+      g_value_set_double (value, xf->mix);
+      break;
+    case PROP_INTERP_METHOD:
+      g_value_set_enum (value, xf->interp_method);
+      break;
+    case PROP_BORDER:
+      g_value_set_int (value, xf->border);
+      break;
+    case PROP_BGCOLOR:
+      g_value_set_uint (value, (xf->bgcolor[BG_ALPHA] << 24) |
+          (xf->bgcolor[BG_RED] << 16) |
+          (xf->bgcolor[BG_GREEN] << 8) | (xf->bgcolor[BG_BLUE] << 0));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (xf);
+}
+
+static void
+gst_kenburns_xfade_finalize (GObject * object)
+{
+  GstKenburnsXfade *xf = GST_KENBURNS_XFADE (object);
+
+  gst_object_unref (xf->collect);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_kenburns_xfade_base_init (gpointer g_class)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (g_class);
+
+  gst_element_class_set_details_simple (element_class, "kenburnsxfade",
+      "Filter/Editor/Video",
+      "Crossfades between two images, each with its own pose",
+      "Lane Brooks <dirjud@gmail.com>");
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&gst_kenburns_xfade_sink_template));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&gst_kenburns_xfade_src_template));
+}
+
+static void
+gst_kenburns_xfade_class_init (GstKenburnsXfadeClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstElementClass *element_class = (GstElementClass *) klass;
+
+  GST_DEBUG_CATEGORY_INIT (gst_kenburns_xfade_debug, "kenburnsxfade", 0,
+      "kenburnsxfade");
+
+  gobject_class->set_property = gst_kenburns_xfade_set_property;
+  gobject_class->get_property = gst_kenburns_xfade_get_property;
+  gobject_class->finalize = gst_kenburns_xfade_finalize;
+
+  g_object_class_install_property (gobject_class, PROP_MIX,
+      g_param_spec_double ("mix", "Mix",
+          "Weight of the image on sink_1, the image on sink_0 has the rest. An image with no weight is not rendered.",
+          0.0, 1.0, DEFAULT_MIX,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE));
+
+  g_object_class_install_property (gobject_class, PROP_INTERP_METHOD,
+      g_param_spec_enum ("interp-method", "Interpolation method",
+          "Method for interpolating the output image",
+          GST_TYPE_KENBURNS_INTERP_METHOD, DEFAULT_INTERP_METHOD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_BORDER,
+      g_param_spec_int ("border", "Frame border on output image",
+          "Number of pixels to use as a border around the output image.",
+          0, G_MAXINT32, DEFAULT_BORDER,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE));
+
+  g_object_class_install_property (gobject_class, PROP_BGCOLOR,
+      g_param_spec_uint ("background-color", "Background Color",
+          "Color to use for background. Should be of the form '(a<<24) | (r<<16) | (g<<8) | (b<<0)' where a is alpha, r is red, g is green, and b is blue. Alpha will be ignored for formats that do not support alpha.",
+          0, G_MAXUINT32, DEFAULT_BGCOLOR,
+          G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE));
+
+  element_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_kenburns_xfade_change_state);
+}
+
+static void
+gst_kenburns_xfade_init (GstKenburnsXfade * xf, GstKenburnsXfadeClass * klass)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstPadTemplate *templ;
+  GstKenburnsXfadePad *pad;
+  gchar *name;
+  gint i;
+
+  xf->srcpad =
+      gst_pad_new_from_static_template (&gst_kenburns_xfade_src_template,
+      "src");
+  gst_pad_use_fixed_caps (xf->srcpad);
+  gst_pad_set_event_function (xf->srcpad,
+      GST_DEBUG_FUNCPTR (gst_kenburns_xfade_src_event));
+  gst_element_add_pad (GST_ELEMENT (xf), xf->srcpad);
+
+  xf->collect = gst_collect_pads_new ();
+  gst_collect_pads_set_function (xf->collect,
+      GST_DEBUG_FUNCPTR (gst_kenburns_xfade_collected), xf);
+
+  templ = gst_element_class_get_pad_template (element_class, "sink_%d");
+  for (i = 0; i < 2; i++) {
+    name = g_strdup_printf ("sink_%d", i);
+    pad = g_object_new (GST_TYPE_KENBURNS_XFADE_PAD, "name", name,
+        "direction", GST_PAD_SINK, "template", templ, NULL);
+    g_free (name);
+    gst_pad_set_getcaps_function (GST_PAD (pad),
+        GST_DEBUG_FUNCPTR (gst_kenburns_xfade_sink_getcaps));
+    gst_pad_set_setcaps_function (GST_PAD (pad),
+        GST_DEBUG_FUNCPTR (gst_kenburns_xfade_sink_setcaps));
+    pad->collect = gst_collect_pads_add_pad (xf->collect, GST_PAD (pad),
+        sizeof (GstCollectData));
+    xf->collect_event = GST_PAD_EVENTFUNC (pad);
+    gst_pad_set_event_function (GST_PAD (pad),
+        GST_DEBUG_FUNCPTR (gst_kenburns_xfade_sink_event));
+    gst_element_add_pad (GST_ELEMENT (xf), GST_PAD (pad));
+    xf->sinkpad[i] = pad;
+  }
+
+  xf->mix = DEFAULT_MIX;
+  xf->interp_method = DEFAULT_INTERP_METHOD;
+  xf->border = DEFAULT_BORDER;
+  xf->bgcolor[BG_ALPHA] = (DEFAULT_BGCOLOR >> 24) & 0xFF;
+  xf->bgcolor[BG_RED] = (DEFAULT_BGCOLOR >> 16) & 0xFF;
+  xf->bgcolor[BG_GREEN] = (DEFAULT_BGCOLOR >> 8) & 0xFF;
+  xf->bgcolor[BG_BLUE] = (DEFAULT_BGCOLOR >> 0) & 0xFF;
+  gst_kenburns_xfade_configure (xf);
+}
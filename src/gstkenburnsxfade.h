@@ -0,0 +1,126 @@
+/* GStreamer
+ * Copyright (C) <2011> Lane Brooks  <dirjud@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_KENBURNS_XFADE_H__
+#define __GST_KENBURNS_XFADE_H__
+
+#include <gst/gst.h>
+#include <gst/base/gstcollectpads.h>
+#include <gst/video/video.h>
+
+#include "gstkenburnsmotion.h"
+#include "gstkenburnsrender.h"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_KENBURNS_XFADE_PAD \
+  (gst_kenburns_xfade_pad_get_type())
+#define GST_KENBURNS_XFADE_PAD(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_KENBURNS_XFADE_PAD,GstKenburnsXfadePad))
+#define GST_IS_KENBURNS_XFADE_PAD(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_KENBURNS_XFADE_PAD))
+
+#define GST_TYPE_KENBURNS_XFADE \
+  (gst_kenburns_xfade_get_type())
+#define GST_KENBURNS_XFADE(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_KENBURNS_XFADE,GstKenburnsXfade))
+#define GST_KENBURNS_XFADE_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_KENBURNS_XFADE,GstKenburnsXfadeClass))
+#define GST_IS_KENBURNS_XFADE(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_KENBURNS_XFADE))
+#define GST_IS_KENBURNS_XFADE_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_KENBURNS_XFADE))
+
+typedef struct _GstKenburnsXfadePad GstKenburnsXfadePad;
+typedef struct _GstKenburnsXfadePadClass GstKenburnsXfadePadClass;
+typedef struct _GstKenburnsXfade GstKenburnsXfade;
+typedef struct _GstKenburnsXfadeClass GstKenburnsXfadeClass;
+
+/**
+ * GstKenburnsXfadePad:
+ *
+ * A sink pad of kenburnsxfade, with the pose its image is shown in as
+ * properties.
+ */
+struct _GstKenburnsXfadePad {
+  GstPad parent;
+
+  /* < private > */
+  GstKenburnsPose pose;
+
+  /* the input of this pad rendered to the output of the element, and the
+   * work buffers of the streaming thread for it */
+  GstKenburnsRenderer renderer;
+  GstKenburnsScratch *scratch;
+  gboolean have_caps;
+
+  /* the latest frame, kept showing once the stream of the pad ended */
+  GstBuffer *last;
+  GstCollectData *collect;
+};
+
+struct _GstKenburnsXfadePadClass {
+  GstPadClass parent_class;
+};
+
+/**
+ * GstKenburnsXfade:
+ *
+ * Opaque datastructure.
+ */
+struct _GstKenburnsXfade {
+  GstElement element;
+
+  /* < private > */
+  GstPad *srcpad;
+  GstKenburnsXfadePad *sinkpad[2];
+  GstCollectPads *collect;
+
+  /* 0 shows sink_0 only, 1 sink_1 only */
+  gdouble mix;
+
+  /* settings shared by the renderers of both pads */
+  GstKenburnsInterpMethod interp_method;
+  gint32 border;
+  guint32 bgcolor[4];
+
+  /* the output, negotiated before the first frame after a caps change */
+  gboolean negotiated;
+  GstVideoFormat format;
+  gint width, height;
+  gint fps_n, fps_d;
+
+  /* a new segment must be pushed before the next frame, as an update if
+   * all the input segments since the last one were updates */
+  gboolean segment_pending;
+  gboolean segment_update;
+  /* the event function collectpads put on the sink pads */
+  GstPadEventFunction collect_event;
+};
+
+struct _GstKenburnsXfadeClass {
+  GstElementClass parent_class;
+};
+
+GType gst_kenburns_xfade_pad_get_type (void);
+GType gst_kenburns_xfade_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_KENBURNS_XFADE_H__ */